@@ -0,0 +1,184 @@
+/* PT6312 is an Arduino library for the PT6312 family of Vacuum Fluorescent Display controllers.
+ * Copyright (C) 2022 Ysard - <ysard@users.noreply.github.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Bus cost of the public API, measured on the host build against the emulator.
+ * For each call: SCLK rising edges, strobe windows, bytes on the wire and
+ * modeled bus time (sum of the _delay_us() of the transport).
+ *
+ * Usage: benchmark <variant name> [budget file]
+ * With a budget file, the program fails if a measure exceeds its budget.
+ */
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include <string>
+#include "PT6312.h"
+#include "host/PT6312_emulator.h"
+
+struct Measure
+{
+    std::string name;
+    uint32_t    clocks;
+    uint32_t    windows;
+    uint32_t    bytes;
+    uint32_t    bus_us;
+};
+
+static PT6312Emulator       emulator;
+static std::vector<Measure> measures;
+static std::string          variant;
+
+
+static void start()
+{
+    VFD_hostReset();
+    emulator.resetCounters();
+}
+
+
+static void stop(const char *name)
+{
+    Measure m;
+    m.name    = variant + "." + name;
+    m.clocks  = vfd_host_bus.clocks;
+    m.windows = vfd_host_bus.strobes;
+    m.bytes   = emulator.commands + emulator.data_bytes + emulator.read_bytes;
+    m.bus_us  = (uint32_t)(vfd_host_bus.time_ns / 1000);
+    measures.push_back(m);
+}
+
+
+/**
+ * @brief Compare the measures to the budget file.
+ *      Line format: <name> <max clocks> <max windows> <max bytes> <max bus us>
+ *      '#' starts a comment. Measures without budget are reported but not checked.
+ * @return Number of exceeded budgets.
+ */
+static int checkBudget(const char *path)
+{
+    FILE *file = fopen(path, "r");
+    if (file == nullptr) {
+        fprintf(stderr, "Can't open budget file %s\n", path);
+        return 1;
+    }
+
+    int  failures = 0;
+    char line[256], name[128];
+    unsigned clocks, windows, bytes, bus_us;
+
+    while (fgets(line, sizeof(line), file)) {
+        if (line[0] == '#')
+            continue;
+        if (sscanf(line, "%127s %u %u %u %u", name, &clocks, &windows, &bytes, &bus_us) != 5)
+            continue;
+
+        for (const Measure &m : measures) {
+            if (m.name != name)
+                continue;
+            if (m.clocks > clocks || m.windows > windows || m.bytes > bytes || m.bus_us > bus_us) {
+                fprintf(stderr, "OVER BUDGET: %s: %u/%u clocks, %u/%u windows, %u/%u bytes, %u/%u us\n",
+                        name, m.clocks, clocks, m.windows, windows, m.bytes, bytes, m.bus_us, bus_us);
+                failures++;
+            }
+        }
+    }
+    fclose(file);
+    return failures;
+}
+
+
+int main(int argc, char *argv[])
+{
+    variant = (argc > 1) ? argv[1] : "variant";
+
+    emulator.attach();
+    VFD_initialize();
+    // The emulator turns the display on only with the data setting that follows
+    VFD_displayOff();
+    VFD_displayOn(PT6312_BRT_DEF);
+    if (!emulator.displayOn()) {
+        fprintf(stderr, "Display not turned on by VFD_displayOn()\n");
+        return 1;
+    }
+
+    // Full refresh of a counter, then an update of its last digit
+    VFD_clear();
+    start();
+    VFD_home();
+    VFD_writeString("12345", false);
+    stop("writeString.full");
+
+    start();
+    VFD_home();
+    VFD_writeString("12346", false);
+    stop("writeString.digit");
+
+    start();
+    VFD_writeCharAt(1, '7');
+    stop("writeCharAt");
+
+    VFD_clear();
+    start();
+    VFD_home();
+    VFD_writeInt(1234, 4, false);
+    stop("writeInt");
+
+    VFD_displayAllSegments();
+    start();
+    VFD_clear();
+    stop("clear");
+
+    VFD_clear();
+    start();
+    VFD_home();
+    VFD_scrollText("HELLO WORLD");
+    stop("scrollText");
+
+    // 1 second of animation (see VFD_busyWrapper())
+    uint8_t frame = 1, loop = 0;
+    start();
+    for (uint16_t i = 0; i < 420; i++) {
+        VFD_busySpinningCircle(1, frame, loop);
+    }
+    stop("busySpinningCircle.x420");
+    if (!emulator.displayOn()) {
+        fprintf(stderr, "Display turned off by the animation\n");
+        return 1;
+    }
+
+    start();
+    VFD_getKeys();
+    stop("getKeys");
+
+    start();
+    VFD_setLEDs(PT6312_LED1);
+    stop("setLEDs");
+
+    printf("%-36s %8s %8s %8s %8s\n", "call", "clocks", "windows", "bytes", "bus_us");
+    for (const Measure &m : measures) {
+        printf("%-36s %8u %8u %8u %8u\n", m.name.c_str(), m.clocks, m.windows, m.bytes, m.bus_us);
+    }
+
+    if (argc > 2) {
+        int failures = checkBudget(argv[2]);
+        if (failures) {
+            fprintf(stderr, "%d measure(s) over budget\n", failures);
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,93 @@
+/* PT6312 is an Arduino library for the PT6312 family of Vacuum Fluorescent Display controllers.
+ * Copyright (C) 2022 Ysard - <ysard@users.noreply.github.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Text on 2 PT6312Display objects sharing the bus (1 emulator per STB line),
+ * checked on the host build: after writeString(), writeInt() and
+ * writeCharAt(), the display memory of each controller must be the
+ * framebuffer of the C API (VFD_* functions) for the same calls.
+ *
+ * Usage: test_display (exit status 1 on failure)
+ */
+#include <stdio.h>
+#include <string.h>
+#include "PT6312_display.h"
+#include "host/PT6312_emulator.h"
+
+typedef VFD_Config<VFD_HostPinsOn<VFD_HOST_STB2>, VFD_GRIDS> Left;
+typedef VFD_Config<VFD_HostPinsOn<VFD_HOST_STB3>, VFD_GRIDS> Right;
+
+static PT6312Emulator left_emulator(VFD_HOST_STB2);
+static PT6312Emulator right_emulator(VFD_HOST_STB3);
+static PT6312Display<Left>  left;
+static PT6312Display<Right> right;
+
+
+/**
+ * @brief Compare the display memory of a controller to the framebuffer of the C API.
+ */
+static int check(const char *name, const PT6312Emulator &emulator)
+{
+    if (memcmp(emulator.display_ram, displayBuffer, PT6312_DISPLAY_MEM) == 0)
+        return 0;
+
+    fprintf(stderr, "FAIL: %s:", name);
+    for (uint8_t i = 0; i < PT6312_DISPLAY_MEM; i++)
+        fprintf(stderr, " %02X/%02X", emulator.display_ram[i], displayBuffer[i]);
+    fprintf(stderr, " (controller/expected)\n");
+    return 1;
+}
+
+
+int main()
+{
+    int failures = 0;
+
+    left_emulator.attach();
+    right_emulator.attach();
+    VFD_initialize();
+    VFD_initializeAll(left, right);
+
+    // Different text on each display
+    VFD_clear();
+    VFD_home();
+    VFD_writeString("12:34", true);
+    left.clear();
+    left.setGridCursor(1);
+    left.writeString("12:34", true);
+    failures += check("left.writeString", left_emulator);
+
+    VFD_clear();
+    VFD_home();
+    VFD_writeInt(-42, 4, false);
+    right.clear();
+    right.setGridCursor(1);
+    right.writeInt(-42, 4, false);
+    failures += check("right.writeInt", right_emulator);
+
+    // Only the character of the right display is modified
+    VFD_writeCharAt(2, '7');
+    right.writeCharAt(2, '7');
+    failures += check("right.writeCharAt", right_emulator);
+
+    VFD_clear();
+    VFD_home();
+    VFD_writeString("12:34", true);
+    failures += check("left unchanged", left_emulator);
+
+    printf("%s: %d failure(s)\n", "test_display", failures);
+    return failures ? 1 : 0;
+}
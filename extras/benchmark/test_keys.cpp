@@ -0,0 +1,138 @@
+/* PT6312 is an Arduino library for the PT6312 family of Vacuum Fluorescent Display controllers.
+ * Copyright (C) 2022 Ysard - <ysard@users.noreply.github.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Events of the key service (VFD_keyService(), VFD_pollKeyEvent()), checked on
+ * the host build: the key matrix is injected in the emulator and the exact
+ * sequence of events is compared to a table.
+ *   - Vote on the 6 samples: pressed in 4 samples or more, released in 2 or
+ *     less, unchanged in 3 (hysteresis).
+ *   - Debounce: a change is accepted after 3 identical polls, a shorter
+ *     bounce is ignored.
+ *   - Long press after 80 polls, then a repeat every 20 polls, for 2 keys.
+ *
+ * Usage: test_keys (exit status 1 on failure)
+ */
+#include <stdio.h>
+#include "PT6312.h"
+#include "host/PT6312_emulator.h"
+
+#if (VFD_KEY_DEBOUNCE_POLLS != 3) || (VFD_KEY_LONG_PRESS_MS / VFD_KEY_POLL_PERIOD_MS != 80) \
+    || (VFD_KEY_REPEAT_MS / VFD_KEY_POLL_PERIOD_MS != 20)
+    #error "The expected events are made for the default key timings of global.h"
+#endif
+
+// Samples (bits 0..5) in which a key (0..3) is seen pressed
+static uint32_t samples(uint8_t key, uint8_t sample_mask)
+{
+    uint32_t raw_keys = 0;
+    for (uint8_t sample = 0; sample < 6; sample++) {
+        if (sample_mask & (1 << sample))
+            raw_keys |= VFD_KEY_BIT(sample, key);
+    }
+    return raw_keys;
+}
+
+struct Step
+{
+    uint32_t raw_keys;  // Key matrix during the step
+    uint8_t  polls;
+};
+
+struct Event
+{
+    uint16_t poll;      // Poll number (from 1) that pushes the event
+    uint8_t  type;
+    uint8_t  key;
+};
+
+static const Step STEPS[] = {
+    // Polls 1..5: key 1 in 3 samples from released: stays released
+    {samples(0, 0x15), 5},
+    // Polls 6..15: key 1 in 4 samples: pressed after 3 polls
+    {samples(0, 0x2D), 10},
+    // Polls 16..25: key 1 in 3 samples from pressed: stays pressed
+    {samples(0, 0x07), 10},
+    // Polls 26..27: bounce shorter than the debounce: ignored
+    {0, 2},
+    // Polls 28..137: keys 1 and 3 held (key 3 in 5 samples)
+    {samples(0, 0x3F) | samples(2, 0x1F), 110},
+    // Polls 138..142: key 1 in 2 samples: released
+    {samples(0, 0x21) | samples(2, 0x3F), 5},
+    // Polls 143..147: all keys released
+    {0, 5},
+};
+
+static const Event EXPECTED[] = {
+    {8,   VFD_KEY_PRESS,      1},
+    {30,  VFD_KEY_PRESS,      3},
+    {88,  VFD_KEY_LONG_PRESS, 1},   // 80 polls after the press
+    {108, VFD_KEY_REPEAT,     1},   // Every 20 polls
+    {110, VFD_KEY_LONG_PRESS, 3},
+    {128, VFD_KEY_REPEAT,     1},
+    {130, VFD_KEY_REPEAT,     3},
+    {140, VFD_KEY_RELEASE,    1},
+    {145, VFD_KEY_RELEASE,    3},
+};
+
+#define MAX_EVENTS  32
+
+static PT6312Emulator emulator;
+
+
+int main()
+{
+    Event    events[MAX_EVENTS];
+    uint8_t  count    = 0;
+    uint16_t poll     = 0;
+    int      failures = 0;
+
+    emulator.attach();
+    VFD_initialize();
+
+    for (const Step &step : STEPS) {
+        emulator.setKeys(step.raw_keys);
+        for (uint8_t i = 0; i < step.polls; i++) {
+            vfd_key_event_t event;
+
+            poll++;
+            VFD_keyService();
+            while (VFD_pollKeyEvent(&event)) {
+                if (count < MAX_EVENTS)
+                    events[count] = {poll, event.type, event.key};
+                count++;
+            }
+        }
+    }
+
+    const uint8_t expected_count = sizeof(EXPECTED) / sizeof(EXPECTED[0]);
+    if (count != expected_count) {
+        fprintf(stderr, "FAIL: %u event(s), expected %u\n", count, expected_count);
+        failures++;
+    }
+    for (uint8_t i = 0; (i < count) && (i < expected_count) && (i < MAX_EVENTS); i++) {
+        const Event &e = events[i];
+        const Event &x = EXPECTED[i];
+        if ((e.poll != x.poll) || (e.type != x.type) || (e.key != x.key)) {
+            fprintf(stderr, "FAIL: event %u: type %u key %u at poll %u, expected type %u key %u at poll %u\n",
+                    i, e.type, e.key, e.poll, x.type, x.key, x.poll);
+            failures++;
+        }
+    }
+
+    printf("%s: %d failure(s)\n", "test_keys", failures);
+    return failures ? 1 : 0;
+}
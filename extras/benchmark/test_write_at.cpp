@@ -0,0 +1,134 @@
+/* PT6312 is an Arduino library for the PT6312 family of Vacuum Fluorescent Display controllers.
+ * Copyright (C) 2022 Ysard - <ysard@users.noreply.github.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Partial writes, checked on the host build for the C API and for a PT6312Display:
+ *   - writeBytesAt(): only the bytes whose mask is not 0 are modified and sent,
+ *     the other pending bytes of the framebuffer stay pending.
+ *   - writeCharAt(): the position is counted from the left of the display,
+ *     whatever the grid cursor (i.e. after clear(), which leaves it on the last grid).
+ *
+ * Usage: test_write_at (exit status 1 on failure)
+ */
+#include <stdio.h>
+#include <string.h>
+#include "PT6312_display.h"
+#include "host/PT6312_emulator.h"
+
+typedef VFD_Config<VFD_HostPinsOn<VFD_HOST_STB2>, VFD_GRIDS> Module;
+
+static PT6312Emulator       emulator;
+static PT6312Emulator       module_emulator(VFD_HOST_STB2);
+static PT6312Display<Module> module;
+
+// C API with the interface of PT6312Display
+struct CApi
+{
+    void setBufferByte(uint8_t address, uint8_t data) { VFD_setBufferByte(address, data); }
+    void writeBytesAt(uint8_t address, uint16_t mask, uint16_t value) { VFD_writeBytesAt(address, mask, value); }
+    void flush() { VFD_flush(); }
+    void clear() { VFD_clear(); }
+    void setGridCursor(uint8_t position) { VFD_setGridCursor(position); }
+    void writeString(const char *string, bool colon_symbol) { VFD_writeString(string, colon_symbol); }
+    void writeCharAt(uint8_t position, char character) { VFD_writeCharAt(position, character); }
+};
+
+// 1st character of the display, the others blank
+#ifdef VFD_VARIANT_1
+#define FIRST_CHAR_LINE  "8      " // Full line of VFD_DISPLAYABLE_DIGITS characters
+#else
+#define FIRST_CHAR_LINE  "8"
+#endif
+
+static int failures = 0;
+
+
+static void expect(const char *name, const char *step, uint32_t value, uint32_t expected)
+{
+    if (value == expected)
+        return;
+    fprintf(stderr, "FAIL: %s: %s is 0x%X, expected 0x%X\n", name, step, value, expected);
+    failures++;
+}
+
+
+template <class Target>
+static void run(const char *name, Target &target, PT6312Emulator &controller)
+{
+    // Byte left pending by the program
+    target.setBufferByte(5, 0xA5);
+
+    // Mask of 0: nothing is sent
+    target.setBufferByte(3, 0x5A);
+    controller.resetCounters();
+    target.writeBytesAt(2, 0, 0);
+    expect(name, "windows (mask 0)", controller.windows, 0);
+    expect(name, "byte 3 (mask 0)", controller.display_ram[3], 0x00);
+
+    // MSB only: only the byte after the address is sent
+    controller.resetCounters();
+    target.writeBytesAt(2, 0xF000, 0x3000);
+    expect(name, "windows (MSB)", controller.windows, 1);
+    expect(name, "byte 2 (MSB)", controller.display_ram[2], 0x00);
+    expect(name, "byte 3 (MSB)", controller.display_ram[3], 0x3A);
+
+    // LSB only
+    controller.resetCounters();
+    target.writeBytesAt(2, 0x00FF, 0x0034);
+    expect(name, "windows (LSB)", controller.windows, 1);
+    expect(name, "byte 2 (LSB)", controller.display_ram[2], 0x34);
+
+    // MSB beyond the display memory: nothing is sent
+    controller.resetCounters();
+    target.writeBytesAt(PT6312_DISPLAY_MEM - 1, 0xFF00, 0xFF00);
+    expect(name, "windows (out of memory)", controller.windows, 0);
+
+    // The pending byte is still pending
+    expect(name, "byte 5 (pending)", controller.display_ram[5], 0x00);
+    target.flush();
+    expect(name, "byte 5 (flushed)", controller.display_ram[5], 0xA5);
+
+    // writeCharAt() after clear(): same memory as the line written after a home
+    uint8_t expected[PT6312_DISPLAY_MEM];
+    target.clear();
+    target.setGridCursor(1);
+    target.writeString(FIRST_CHAR_LINE, false);
+    memcpy(expected, controller.display_ram, PT6312_DISPLAY_MEM);
+
+    target.clear();
+    controller.resetCounters();
+    target.writeCharAt(1, '8');
+    expect(name, "windows (writeCharAt)", controller.windows, 1);
+    for (uint8_t i = 0; i < PT6312_DISPLAY_MEM; i++)
+        expect(name, "byte (writeCharAt)", controller.display_ram[i], expected[i]);
+}
+
+
+int main()
+{
+    CApi c_api;
+
+    emulator.attach();
+    module_emulator.attach();
+    VFD_initialize();
+    module.initialize();
+
+    run("C API", c_api, emulator);
+    run("PT6312Display", module, module_emulator);
+
+    printf("%s: %d failure(s)\n", "test_write_at", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,139 @@
+/* PT6312 is an Arduino library for the PT6312 family of Vacuum Fluorescent Display controllers.
+ * Copyright (C) 2022 Ysard - <ysard@users.noreply.github.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Framebuffer of VFD_writeString() for the display variant 1 (slot layout,
+ * colon symbols), checked on the host build.
+ *   - Table of expected framebuffers: strings with colons, 1-2 characters,
+ *     trailing colons, etc.
+ *   - Checksum of the framebuffers of 2400 pseudo-random strings of 3 to 10
+ *     characters without colon, identical to the implementation before the
+ *     slot table (the framebuffers of the table that differ from it are the
+ *     out of bounds reads and repeated characters that it had).
+ *
+ * Usage: test_write_string (exit status 1 on failure)
+ */
+#include <stdio.h>
+#include "PT6312.h"
+
+#ifndef VFD_VARIANT_1
+    #error "This test is made for the display variant 1"
+#endif
+
+struct Case
+{
+    const char *string;
+    uint8_t     expected[PT6312_DISPLAY_MEM];
+};
+
+static const Case CASES[] = {
+    // 1-2 characters: fixed (the old code read before the string)
+    {"0", {0x77, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}},
+    {"7", {0x64, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}},
+    {"12", {0x6B, 0x12, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}},
+    // Trailing colon: lit after the last character
+    {"A:", {0xFE, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}},
+    {"1:", {0xA4, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}},
+    {"12:", {0xEB, 0x12, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}},
+    // Colons: identical to the old code
+    {"88:88:88", {0xFF, 0x3F, 0xFF, 0x7F, 0xFF, 0x7F, 0x00, 0x00, 0x00, 0x00}},
+    {"12:345", {0x5D, 0x1E, 0x6D, 0xEB, 0x24, 0x00, 0x00, 0x00, 0x00, 0x00}},
+    {"1:2345", {0x5D, 0x1E, 0x6D, 0x6B, 0xA4, 0x00, 0x00, 0x00, 0x00, 0x00}},
+    // Colons close to the end: fixed (the old code repeated a character)
+    {"12:34:56", {0xDF, 0x2E, 0xBC, 0x6D, 0xEB, 0x24, 0x00, 0x00, 0x00, 0x00}},
+    {"123:45:67", {0xE4, 0x2F, 0xDD, 0x3C, 0xED, 0x6B, 0x24, 0x00, 0x00, 0x00}},
+    // Full line, extra characters ignored
+    {"1234567", {0xE4, 0x2F, 0x5D, 0x3C, 0x6D, 0x6B, 0x24, 0x00, 0x00, 0x00}},
+    {"HELLO W", {0x38, 0x00, 0x77, 0x13, 0x13, 0x5B, 0x1E, 0x00, 0x00, 0x00}},
+    {"12345678901", {0xE4, 0x2F, 0x5D, 0x3C, 0x6D, 0x6B, 0x24, 0x00, 0x00, 0x00}},
+    // Colons without a previous character are ignored
+    {"::1", {0x24, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}},
+    // Repeated colons: 1 symbol
+    {"1::2", {0x6B, 0x52, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}},
+    // Blank, spaces and characters without glyph
+    {"", {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}},
+    {" 1 2 3", {0x6D, 0x00, 0x6B, 0x00, 0x24, 0x00, 0x00, 0x00, 0x00, 0x00}},
+    {"-12.5", {0x5D, 0x00, 0x6B, 0x24, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00}},
+};
+
+// FNV-1a of the framebuffers of the pseudo-random strings
+#define RANDOM_STRINGS_HASH  0x047AB4A0UL
+
+
+/**
+ * @brief Write the string at the grid 1 of a blank framebuffer.
+ */
+static void render(const char *string)
+{
+    for (uint8_t i = 0; i < PT6312_DISPLAY_MEM; i++)
+        VFD_setBufferByte(i, 0);
+    VFD_setGridCursor(1);
+    VFD_writeString(string, false);
+}
+
+
+static uint32_t seed = 12345;
+
+// Linear congruential generator: the same strings on every host
+static uint8_t nextRandom(uint8_t n)
+{
+    seed = seed * 1103515245UL + 12345;
+    return (seed >> 16) % n;
+}
+
+
+int main()
+{
+    int failures = 0;
+
+    VFD_initialize();
+
+    for (const Case &c : CASES) {
+        render(c.string);
+        for (uint8_t i = 0; i < PT6312_DISPLAY_MEM; i++) {
+            if (displayBuffer[i] != c.expected[i]) {
+                fprintf(stderr, "FAIL: \"%s\": byte %u is 0x%02X, expected 0x%02X\n",
+                        c.string, i, displayBuffer[i], c.expected[i]);
+                failures++;
+                break;
+            }
+        }
+    }
+
+    const char charset[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ -";
+    uint32_t   hash      = 2166136261UL;
+    for (uint16_t n = 0; n < 2400; n++) {
+        char    string[11];
+        uint8_t len = 3 + nextRandom(8);
+        for (uint8_t i = 0; i < len; i++)
+            string[i] = charset[nextRandom(sizeof(charset) - 1)];
+        string[len] = '\0';
+
+        render(string);
+        for (uint8_t i = 0; i < PT6312_DISPLAY_MEM; i++) {
+            hash ^= displayBuffer[i];
+            hash *= 16777619UL;
+        }
+    }
+    if (hash != RANDOM_STRINGS_HASH) {
+        fprintf(stderr, "FAIL: random strings: hash 0x%08lX, expected 0x%08lX\n",
+                (unsigned long)hash, (unsigned long)RANDOM_STRINGS_HASH);
+        failures++;
+    }
+
+    printf("%s: %d failure(s)\n", "test_write_string", failures);
+    return failures ? 1 : 0;
+}
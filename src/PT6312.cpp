@@ -22,6 +22,30 @@
 //#include "HardwareSerial.h" // For help debug
 
 uint8_t grid_cursor;
+uint8_t displayBuffer[PT6312_DISPLAY_MEM];
+vfd_dirty_t dirty_mask;
+#if ENABLE_DOUBLE_BUFFER == 1
+uint8_t frontBuffer[PT6312_DISPLAY_MEM];
+static bool front_valid;
+#endif
+#if ENABLE_GRAYSCALE == 1
+#if ENABLE_DOUBLE_BUFFER == 1
+    #error "ENABLE_GRAYSCALE can't be used with ENABLE_DOUBLE_BUFFER"
+#endif
+/**
+ * State of the grayscale engine (see VFD_grayscaleRefresh())
+ * The level of a segment is stored as an attenuation (VFD_GRAY_MAX - level) split
+ * in bit-planes: bit b of the attenuation of a segment is in dim[b]
+ * (zero initialized: all the segments at full intensity).
+ */
+static struct {
+    uint8_t dim[VFD_GRAY_BITS][PT6312_DISPLAY_MEM]; // Segments hidden during the plane
+    uint8_t sent[PT6312_DISPLAY_MEM];               // Bytes displayed by the controller
+    bool    sent_valid;
+    uint8_t plane;                                  // Displayed plane
+    uint8_t remaining;                              // Refreshes before the next plane
+} gray;
+#endif
 
 // Select font & functions according to global.h setting
 #if defined(VFD_VARIANT_1)
@@ -41,46 +65,21 @@ uint8_t grid_cursor;
 void VFD_initialize(void)
 {
     // Configure pins
-    _pinMode(VFD_CS_DDR, VFD_CS_PIN, _OUTPUT);
-    _pinMode(VFD_SCLK_DDR, VFD_SCLK_PIN, _OUTPUT);
-    _pinMode(VFD_DATA_DDR, VFD_DATA_PIN, _OUTPUT);
-
-    _digitalWrite(VFD_CS_PORT, VFD_CS_PIN, _HIGH);
-    _digitalWrite(VFD_SCLK_PORT, VFD_SCLK_PIN, _HIGH);
+    VFD_transportInit();
 
     // Waiting for the VFD driver to startup
     _delay_ms(500);
 
     // Configure the controller
     // Set display mode (number of digits & segments)
-    #if VFD_GRIDS == 4
-        VFD_command(PT6312_GR4_SEG16, 1);  // 4 digits, 16 segments
-        #define VFD_SEGMENTS 16
-    #elif VFD_GRIDS == 5
-        VFD_command(PT6312_GR5_SEG16, 1);  // 5 digits, 16 segments
-        #define VFD_SEGMENTS 16
-    #elif VFD_GRIDS == 6
-        VFD_command(PT6312_GR6_SEG16, 1);  // 6 digits, 16 segments
-        #define VFD_SEGMENTS 16
-    #elif VFD_GRIDS == 7
-        VFD_command(PT6312_GR7_SEG15, 1);  // 7 digits, 15 segments
-        #define VFD_SEGMENTS 15
-    #elif VFD_GRIDS == 8
-        VFD_command(PT6312_GR8_SEG14, 1);  // 8 digits, 14 segments
-        #define VFD_SEGMENTS 14
-    #elif VFD_GRIDS == 9
-        VFD_command(PT6312_GR9_SEG13, 1);  // 9 digits, 13 segments
-        #define VFD_SEGMENTS 13
-    #elif VFD_GRIDS == 10
-        VFD_command(PT6312_GR10_SEG12, 1); // 10 digits, 12 segments
-        #define VFD_SEGMENTS 12
-    #elif VFD_GRIDS == 11
-        VFD_command(PT6312_GR11_SEG11, 1); // 11 digits, 11 segments
-        #define VFD_SEGMENTS 11
-    #endif
+    VFD_command(VFD_Geometry<VFD_GRIDS>::mode, true);
 
     VFD_resetDisplay();
 
+    // The content of the controller memory is unknown at startup:
+    // the whole (blank) framebuffer will be sent by the next VFD_flush()
+    VFD_invalidate();
+
     grid_cursor = 1;
 }
 
@@ -92,12 +91,12 @@ void VFD_initialize(void)
  */
 void VFD_resetDisplay(void)
 {
-    // Turn on the display
+    // The commands are sent even if the controller should already have these settings
+    VFD_Driver::forgetState();
+
+    // Turn on the display, then set the default write mode
     // Display control cmd, display on/off, default brightness
     VFD_displayOn(PT6312_BRT_DEF);
-
-    // Data set cmd, normal mode, auto incr, write data to memory
-    VFD_command(PT6312_DATA_SET_CMD | PT6312_MODE_NORM | PT6312_ADDR_INC | PT6312_DATA_WR, true);
 }
 
 
@@ -110,11 +109,139 @@ void VFD_setBrightness(const uint8_t brightness)
 {
     // Display control cmd, display on/off, brightness
     // mask invalid bits with PT6312_BRT_MSK
-    VFD_command(PT6312_DSP_CTRL_CMD | PT6312_DSP_ON | (brightness & PT6312_BRT_MSK), true);
+    // The command (followed by the write mode) is not sent if the brightness is unchanged
+    VFD_Driver::displayControl(PT6312_DSP_CTRL_CMD | PT6312_DSP_ON | (brightness & PT6312_BRT_MSK));
+}
+
+
+#if (VFD_FADE_STEPS & (VFD_FADE_STEPS - 1)) || (VFD_FADE_STEPS > 32)
+    #error "VFD_FADE_STEPS must be a power of 2 (max 32)"
+#endif
+
+/**
+ * State of the fade service
+ */
+static struct {
+    volatile bool running;
+    uint8_t       level;    // Current level (0..VFD_FADE_MAX)
+    uint8_t       target;
+    uint8_t       steps;    // Levels between the start and the target
+    uint16_t      ticks;    // Refreshes of the ramp
+    uint16_t      error;    // Error term of the ramp (Bresenham)
+    uint8_t       dither;   // Accumulated fractions of brightness step
+    uint32_t      last_ms;  // Time of the last refresh
+} fade;
+
+
+/**
+ * @brief Fade the brightness to the given level in the background.
+ *      The levels are advanced by VFD_fadeRefresh() (from a timer interrupt)
+ *      or VFD_fadeTick() (from the main loop); the program is never blocked.
+ *      VFD_FADE_STEPS levels are made between 2 brightness steps by dithering
+ *      the display control command across the refreshes: each change of the
+ *      brightness is 1 command, nothing is sent while it is unchanged.
+ *      A level between 2 brightness steps is held by the refreshes until
+ *      the next call to VFD_fadeTo() or VFD_fadeStop().
+ *      The fade starts from the current level (from the brightness if the
+ *      service is stopped, from 0 if the display is off).
+ * @param level Valid range 0..VFD_FADE_MAX; the level of the brightness n is
+ *      n * VFD_FADE_STEPS.
+ * @param duration_ms Duration of the ramp in milliseconds (0: immediate).
+ * @warning VFD_setBrightness() must not be used while the service is running.
+ */
+void VFD_fadeTo(uint8_t level, uint16_t duration_ms)
+{
+    bool was_running = fade.running;
+
+    fade.running = false;
+
+    if (!was_running) {
+        uint8_t display_control = VFD_Driver::display_control;
+        fade.level = (display_control & PT6312_DSP_ON) ?
+            (display_control & PT6312_BRT_MSK) * VFD_FADE_STEPS : 0;
+        fade.dither = 0;
+    }
+
+    fade.target = (level > VFD_FADE_MAX) ? VFD_FADE_MAX : level;
+    fade.steps  = (fade.target > fade.level) ? fade.target - fade.level : fade.level - fade.target;
+    fade.ticks  = duration_ms / VFD_FADE_PERIOD_MS;
+    if (fade.ticks == 0) {
+        fade.ticks = 1;
+    } else if (fade.ticks > 0xFFFF - VFD_FADE_MAX) {
+        // The error term must not overflow
+        fade.ticks = 0xFFFF - VFD_FADE_MAX;
+    }
+    fade.error   = 0;
+    fade.running = true;
+}
+
+
+/**
+ * @brief Stop the fade started by VFD_fadeTo().
+ *      The last brightness sent stays on the display.
+ */
+void VFD_fadeStop(void)
+{
+    fade.running = false;
+}
+
+
+/**
+ * @brief Advance the fade once; to be called every VFD_FADE_PERIOD_MS.
+ *      The ramp makes (target - start) levels in duration_ms / VFD_FADE_PERIOD_MS
+ *      refreshes. A level between the brightness n and n + 1 displays n + 1
+ *      in (level % VFD_FADE_STEPS) refreshes out of VFD_FADE_STEPS.
+ *      This function can be called from a timer compare interrupt:
+ *      the refresh is skipped if a transmission with the controller is in progress
+ *      (CS/Strobe LOW).
+ */
+void VFD_fadeRefresh(void)
+{
+    if (!fade.running || !VFD_transportIdle())
+        return;
+
+    if (fade.level != fade.target) {
+        fade.error += fade.steps;
+        while (fade.error >= fade.ticks) {
+            fade.error -= fade.ticks;
+            fade.level += (fade.level < fade.target) ? 1 : -1;
+        }
+    }
+
+    // Dithering between the brightness n and n + 1
+    uint8_t brightness = fade.level / VFD_FADE_STEPS;
+    fade.dither += fade.level & (VFD_FADE_STEPS - 1);
+    if (fade.dither >= VFD_FADE_STEPS) {
+        fade.dither -= VFD_FADE_STEPS;
+        brightness++;
+    }
+    VFD_setBrightness(brightness);
+
+    if ((fade.level == fade.target) && !(fade.level & (VFD_FADE_STEPS - 1))) {
+        // Brightness step reached: nothing to dither
+        fade.running = false;
+    }
+}
+
 
-    // Don't really know why, but this line (or a set mode command) is required to wake up the display
-    // Data set cmd, normal mode, auto incr, write data to memory
-    VFD_command(PT6312_DATA_SET_CMD | PT6312_MODE_NORM | PT6312_ADDR_INC | PT6312_DATA_WR, true);
+/**
+ * @brief Advance the fade if VFD_FADE_PERIOD_MS is elapsed since the last
+ *      refresh; to be called as often as possible from the main loop.
+ * @param now_ms Current time in milliseconds (i.e. millis()).
+ *      Overflows of the counter are supported.
+ * @return true while the fade is running (ramp or level held by dithering).
+ */
+bool VFD_fadeTick(uint32_t now_ms)
+{
+    if (!fade.running)
+        return false;
+
+    if ((uint32_t)(now_ms - fade.last_ms) >= VFD_FADE_PERIOD_MS) {
+        // Late refreshes are not caught up
+        fade.last_ms = now_ms;
+        VFD_fadeRefresh();
+    }
+    return fade.running;
 }
 
 
@@ -127,36 +254,263 @@ void VFD_setBrightness(const uint8_t brightness)
  */
 void VFD_clear(void)
 {
-    // Set addr to 1st memory cell, no CS assertion
-    VFD_setGridCursor(1, false);
-
-    for(uint8_t i=0; i<VFD_GRIDS; i++){
-        // Display a segment
-        VFD_command(0, false);
-        VFD_command(0, false);
+    for (uint8_t i = 0; i < PT6312_DISPLAY_MEM; i++)
+    {
+        VFD_setBufferByte(i, 0);
     }
-    VFD_CSSignal();
+    VFD_flush();
     grid_cursor = VFD_GRIDS;
 }
 
 
 /**
- * @brief Set the cursor on the controller memory according to the given grid position.
+ * @brief Write a byte in the shadow framebuffer at the given address.
+ *      The byte is flagged as dirty only if its value is modified;
+ *      it will be sent to the controller by the next call to VFD_flush().
+ * @param address Value range 0..PT6312_DISPLAY_MEM - 1. Other addresses are ignored.
+ * @param data Byte to write at the given address.
+ */
+void VFD_setBufferByte(uint8_t address, uint8_t data)
+{
+    if (address >= PT6312_DISPLAY_MEM)
+        return;
+
+    if (displayBuffer[address] != data) {
+        displayBuffer[address] = data;
+        dirty_mask |= (vfd_dirty_t)1 << address;
+    }
+}
+
+
+/**
+ * @brief Send the dirty bytes of the shadow framebuffer to the controller.
+ *      Each run of contiguous dirty bytes is sent in 1 transmission:
+ *      address setting command followed by the data bytes (the address is
+ *      auto-incremented by the controller).
+ *      Nothing is sent if the framebuffer is clean.
+ * @note A single clean byte between 2 dirty runs is sent again, it's cheaper
+ *      than a new address command and a new strobe window.
+ * @note With ENABLE_DOUBLE_BUFFER, this function does nothing:
+ *      the framebuffer is the back buffer, sent by VFD_present().
+ *      The blocking loops (VFD_scrollText(), VFD_displayAllSegments(), etc.)
+ *      call VFD_present() after each frame; the spinning circle and the
+ *      animations send their own bytes (see VFD_flushRange()).
+ *      With ENABLE_GRAYSCALE, the framebuffer is sent by VFD_grayscaleRefresh().
+ */
+void VFD_flush(void)
+{
+    #if ENABLE_DOUBLE_BUFFER == 0 && ENABLE_GRAYSCALE == 0
+    vfd_dirty_t pending = dirty_mask;
+
+    dirty_mask = 0;
+    VFD_Driver::flush(displayBuffer, pending);
+    #endif
+}
+
+
+/**
+ * @brief Send the dirty bytes of a range of the shadow framebuffer, without the
+ *      other pending bytes (i.e. a line being drawn by the program).
+ *      The dirty runs of the range are sent like with VFD_flush().
+ *      Its dirty bits are cleared atomically: this function can be used from
+ *      an interrupt service on bytes that the program doesn't modify.
+ * @param address First byte; value range 0..PT6312_DISPLAY_MEM - 1.
+ * @param len Number of bytes; the range stops at the end of the framebuffer.
+ * @note With ENABLE_DOUBLE_BUFFER, the bytes are displayed at once
+ *      (they are copied in the front buffer).
+ *      With ENABLE_GRAYSCALE, the framebuffer is sent by VFD_grayscaleRefresh().
+ */
+void VFD_flushRange(uint8_t address, uint8_t len)
+{
+    #if ENABLE_GRAYSCALE == 1
+    (void)address;
+    (void)len;
+    #else
+    if ((address >= PT6312_DISPLAY_MEM) || (len == 0))
+        return;
+    if (len > PT6312_DISPLAY_MEM - address)
+        len = PT6312_DISPLAY_MEM - address;
+
+    vfd_dirty_t range = ((vfd_dirty_t)~(vfd_dirty_t)0 >> (sizeof(vfd_dirty_t) * 8 - len)) << address;
+    vfd_dirty_t pending;
+
+    VFD_ATOMIC {
+        pending     = dirty_mask & range;
+        dirty_mask &= ~range;
+    }
+    VFD_Driver::flush(displayBuffer, pending);
+
+    #if ENABLE_DOUBLE_BUFFER == 1
+    for (uint8_t i = address; i < address + len; i++) {
+        frontBuffer[i] = displayBuffer[i];
+    }
+    #endif
+    #endif
+}
+
+
+/**
+ * @brief Flag the whole shadow framebuffer as dirty.
+ *      Must be used to resynchronize the controller memory after bytes have been
+ *      sent without the framebuffer (i.e. by using VFD_command() directly).
+ */
+void VFD_invalidate(void)
+{
+    dirty_mask = (vfd_dirty_t)~(vfd_dirty_t)0 >> (sizeof(vfd_dirty_t) * 8 - PT6312_DISPLAY_MEM);
+    #if ENABLE_DOUBLE_BUFFER == 1
+    front_valid = false;
+    #endif
+    #if ENABLE_GRAYSCALE == 1
+    gray.sent_valid = false;
+    #endif
+}
+
+
+/**
+ * @brief Display the frame drawn in the back buffer.
+ *      The bytes that differ from the displayed frame (front buffer) are sent
+ *      in 1 transmission, from the first to the last modified byte:
+ *      the new frame appears at once, without mixed old/new digits.
+ *      The back buffer is kept as is and can be modified right after the call
+ *      (with ENABLE_ASYNC_TX, the bytes are already copied in the queue).
+ *      Without ENABLE_DOUBLE_BUFFER, this function is equivalent to VFD_flush().
+ */
+void VFD_present(void)
+{
+    #if ENABLE_DOUBLE_BUFFER == 1
+    uint8_t first = PT6312_DISPLAY_MEM, last = 0;
+
+    for (uint8_t i = 0; i < PT6312_DISPLAY_MEM; i++) {
+        if (!front_valid || (displayBuffer[i] != frontBuffer[i])) {
+            if (first == PT6312_DISPLAY_MEM)
+                first = i;
+            last = i;
+        }
+    }
+
+    dirty_mask  = 0;
+    front_valid = true;
+    if (first == PT6312_DISPLAY_MEM)
+        return;
+
+    VFD_writeBurst(first, &displayBuffer[first], last - first + 1);
+
+    // Swap: the back buffer is now displayed
+    for (uint8_t i = first; i <= last; i++) {
+        frontBuffer[i] = displayBuffer[i];
+    }
+    #else
+    VFD_flush();
+    #endif
+}
+
+
+#if ENABLE_GRAYSCALE == 1
+/**
+ * @brief Set the intensity of segments (ENABLE_GRAYSCALE must be set).
+ *      The segments keep their level until it is modified, whatever is written
+ *      in the framebuffer: a text, an icon or a bar can be faded independently.
+ * @param address Address of the byte in the display memory;
+ *      value range 0..PT6312_DISPLAY_MEM - 1. Other addresses are ignored.
+ * @param segments Bits of the segments in the byte.
+ * @param level Value range 0 (off)..VFD_GRAY_MAX (full intensity, default).
+ */
+void VFD_setSegmentLevel(uint8_t address, uint8_t segments, uint8_t level)
+{
+    if (address >= PT6312_DISPLAY_MEM)
+        return;
+    if (level > VFD_GRAY_MAX)
+        level = VFD_GRAY_MAX;
+
+    uint8_t attenuation = VFD_GRAY_MAX - level;
+
+    for (uint8_t b = 0; b < VFD_GRAY_BITS; b++) {
+        if (attenuation & (1 << b)) {
+            gray.dim[b][address] |= segments;
+        } else {
+            gray.dim[b][address] &= ~segments;
+        }
+    }
+}
+
+
+/**
+ * @brief Set the intensity of all the segments of a grid (ENABLE_GRAYSCALE must be set).
+ * @param position Grid number; value range 1..VFD_GRIDS.
+ * @param level Value range 0 (off)..VFD_GRAY_MAX (full intensity, default).
+ * @see VFD_setSegmentLevel()
+ */
+void VFD_setGridLevel(uint8_t position, uint8_t level)
+{
+    uint8_t address = (position * PT6312_BYTES_PER_GRID) - PT6312_BYTES_PER_GRID;
+
+    for (uint8_t i = 0; i < PT6312_BYTES_PER_GRID; i++) {
+        VFD_setSegmentLevel(address + i, 0xFF, level);
+    }
+}
+
+
+/**
+ * @brief Render the framebuffer with the segment levels; to be called from a timer
+ *      compare interrupt every VFD_GRAYSCALE_PERIOD_US (ENABLE_GRAYSCALE must be set).
+ *      Binary-coded modulation: the plane b of the levels is displayed for 2^b
+ *      refreshes; a cycle lasts VFD_GRAY_MAX refreshes and a segment of level L
+ *      is lit during L refreshes of it.
+ *      At a change of plane, only the bytes that differ from the displayed ones
+ *      are sent (1 burst per run of modified bytes); nothing is sent in between
+ *      unless the display must be resynchronized (see VFD_invalidate()).
+ *      The bytes written in the framebuffer appear at the next change of plane.
+ *      The refresh is skipped if a transmission with the controller is in progress
+ *      (CS/Strobe LOW).
+ */
+void VFD_grayscaleRefresh(void)
+{
+    if (!VFD_transportIdle())
+        return;
+
+    if (gray.remaining > 1) {
+        gray.remaining--;
+        if (gray.sent_valid)
+            return;
+    } else {
+        // Next plane, from the most significant one
+        gray.plane     = (gray.plane == 0) ? VFD_GRAY_BITS - 1 : gray.plane - 1;
+        gray.remaining = 1 << gray.plane;
+    }
+
+    const uint8_t *dim     = gray.dim[gray.plane];
+    vfd_dirty_t    pending = 0;
+
+    for (uint8_t i = 0; i < PT6312_DISPLAY_MEM; i++) {
+        uint8_t data = displayBuffer[i] & ~dim[i];
+        if (!gray.sent_valid || (data != gray.sent[i])) {
+            gray.sent[i] = data;
+            pending |= (vfd_dirty_t)1 << i;
+        }
+    }
+
+    dirty_mask      = 0;
+    gray.sent_valid = true;
+    VFD_Driver::flush(gray.sent, pending);
+}
+#endif
+
+
+/**
+ * @brief Set the cursor on the shadow framebuffer according to the given grid position.
  *      The first address of a grid will be selected for writing.
- *      Should be used BEFORE sending segments data.
+ *      Should be used BEFORE writing segments data.
  *      Ex: If PT6312_BYTES_PER_GRID == 2 (default), position 1 relies on the first grid,
- *      the memory address on the controller will be 0.
+ *      the memory address will be 0.
  *      Position 2 relies on the 2nd grid, the address will be 2 (2 bytes further).
  * @param position Position where the next segments will be written.
  *      Valid range 1..VFD_GRIDS.
  *      If position == VFD_GRIDS + 1: The first grid will be selected.
  *      If position > VFD_GRIDS + 1 or VFD_GRIDS == 0: The last grid will be selected.
- * @param cmd (Optional) Boolean transmitted to VFD_command();
- *      If True the CS/Strobe line is asserted to HIGH (end of transmission)
- *      after setting the address.
- *      Default: false
+ * @note Nothing is sent to the controller: the address setting command
+ *      is emitted by VFD_flush() with the modified data.
  */
-void VFD_setGridCursor(uint8_t position, bool cmd)
+void VFD_setGridCursor(uint8_t position)
 {
     if (position > VFD_GRIDS) {
         if (position == VFD_GRIDS + 1) {
@@ -169,62 +523,94 @@ void VFD_setGridCursor(uint8_t position, bool cmd)
     }
 
     grid_cursor = position;
+}
+
+
+// Powers of 10 of the int32 range, used to extract decimal digits without division
+static const uint32_t POWERS_OF_10[] PROGMEM = {
+    1000000000, 100000000, 10000000, 1000000, 100000, 10000, 1000, 100, 10
+};
+
+
+/**
+ * @brief Get the decimal digits of a number by subtracting powers of 10.
+ * @param magnitude Number to convert.
+ * @param digits ASCII digits, most significant first; leading zeros are skipped
+ *      (0 has no digit). Must hold 10 characters; not null terminated.
+ * @return Number of digits.
+ */
+static uint8_t decimalDigits(uint32_t magnitude, char *digits)
+{
+    uint8_t length = 0;
+
+    for (uint8_t i = 0; i < sizeof(POWERS_OF_10) / sizeof(POWERS_OF_10[0]); i++)
+    {
+        uint32_t power = pgm_read_dword(&POWERS_OF_10[i]);
+        char     digit = '0';
+
+        while (magnitude >= power) {
+            magnitude -= power;
+            digit++;
+        }
+        if (length || digit != '0')
+            digits[length++] = digit;
+    }
+    if (length || magnitude)
+        digits[length++] = '0' + magnitude;
 
-    // Map position to memory (x bytes per digit)
-    position = (position * PT6312_BYTES_PER_GRID) - PT6312_BYTES_PER_GRID;
-    // Address setting command: set an address of the display memory (0 to 15, 5 lowest bits)
-    VFD_command(PT6312_ADDR_SET_CMD | (position & PT6312_ADDR_MSK), cmd);
+    return length;
 }
 
 
 /**
  * @brief Write a number
- * @param number Number to display. Can be negative.
+ * @param number Number to display. Can be negative (full int32_t range).
  * @param digits_number Number of reserved characters to represent the given number.
  *      If the number is negative, the minus sign '-' will be counted in the digits_number;
  *      thus the digit_number is always respected.
  *      If the number representation uses more space than digits_number,
- *      it will be divided by 10 until it fits in the reserved space.
+ *      its units are discarded until it fits in the reserved space.
  *      If the number representation uses less space than digits_number,
  *      it will be padded with zeros.
  * @param colon_symbol Boolean set to true to display the special colon symbol
  *      segment if possible (See VFD_writeString()).
+ * @see VFD_formatInt()
  */
 void VFD_writeInt(int32_t number, int8_t digits_number, bool colon_symbol)
 {
-    int16_t number_temp = number;
-    uint8_t length      = 0;
-    bool    isNegative  = false;
+    char string[VFD_DISPLAYABLE_DIGITS + 1];
 
-    // Find number of digits
-    // TODO: no check of uint8 overflow here or later (by adding minus sign)
-    while (number_temp != 0) {
-        length++;
-        number_temp /= 10;
-    }
+    VFD_formatInt(string, number, digits_number, grid_cursor);
+    VFD_writeString(string, colon_symbol);
+}
 
-    // Reserve 1 space for the sign
-    // Note: If we don't want to count the sign in the digits_number restriction
-    //  move this block after the next block of length adjustments.
-    if (number < 0) {
-        // Switch to positive number
-        number = -number;
-        length++;
-        isNegative = true;
-    }
 
-    // Adjust the number to digits_number param
-    if (length < digits_number) {
-        // Add remaining wanted space (filled later by zeros)
-        length += digits_number - length;
-    } else if (length > digits_number) {
+/**
+ * @brief Format a number (used by VFD_writeInt() and PT6312Display::writeInt()).
+ *      See VFD_writeInt() for the padding and the discarded units; the string
+ *      is also cut from the left to fit in the characters after the grid position.
+ * @param string Buffer of VFD_DISPLAYABLE_DIGITS + 1 characters; null terminated.
+ * @param number Number to format. Can be negative (full int32_t range).
+ * @param digits_number Number of reserved characters, the minus sign included.
+ * @param position Grid where the string will be written (i.e. the grid cursor).
+ * @return Length of the string.
+ * @note Digits are extracted by subtracting powers of 10: there is no 32-bit
+ *      division (a costly libgcc call on AVR).
+ */
+uint8_t VFD_formatInt(char *string, int32_t number, int8_t digits_number, uint8_t position)
+{
+    bool     isNegative = number < 0;
+    // Switch to positive number; -INT32_MIN doesn't fit in an int32_t
+    uint32_t magnitude  = (isNegative) ? -(uint32_t)number : number;
+    char     digits[10];
+    uint8_t  length     = decimalDigits(magnitude, digits);
+
+    // Adjust the number to digits_number param; 1 space is reserved for the sign
+    uint8_t reserved = (digits_number > 0) ? digits_number : 0;
+    if (length + isNegative > reserved) {
         // Reduce the size of the number by discarding units
-        // Ex: 100 to 1 digit: 2 divisions by 10 are made
-        for (uint8_t i = 0; i < (length - digits_number); i++)
-        {
-            number /= 10;
-        }
-        length = digits_number;
+        // Ex: 100 to 1 digit: 2 digits are dropped
+        length = (reserved > isNegative) ? reserved - isNegative : 0;
     }
 
     // Avoid a memory overflow if digit is too long
@@ -232,30 +618,115 @@ void VFD_writeInt(int32_t number, int8_t digits_number, bool colon_symbol)
     // WARNING: This code will cut the string from left (not from right like previous adjustments)
     // Ex: VFD_writeInt(-123456, 7, true); on a 6 digits display.
     // Will display: -23456 (The 1 is dropped here)
-    uint8_t remaining_space  = VFD_DISPLAYABLE_DIGITS - grid_cursor + 1;
-    uint8_t size             = ((length > remaining_space) ? remaining_space : length);
-    char    string[size + 1] = ""; // +1 for null byte
-
-    if (isNegative) {
+    uint8_t remaining_space = VFD_DISPLAYABLE_DIGITS - position + 1;
+    if (remaining_space > VFD_DISPLAYABLE_DIGITS)
+        remaining_space = VFD_DISPLAYABLE_DIGITS;
+    uint8_t size = (reserved > remaining_space) ? remaining_space : reserved;
+    uint8_t first = (isNegative && size) ? 1 : 0;
+
+    string[size] = '\0';
+    if (first) {
         string[0] = '-';
     }
 
-    for (uint8_t i = size - 1; i >= (isNegative) ? 1 : 0; --i)
+    // Fill from the right: units first, then the padding zeros
+    for (int8_t i = size - 1; i >= first; --i)
     {
-        // Convert number to ASCII value
-        // PS: even if the modulo is 0, the displayed number will be 0
-        // => takes care of the digits_number param.
-        string[i] = (number % 10) + 0x30;
-        number   /= 10;
+        string[i] = (length) ? digits[--length] : '0';
     }
+    return size;
+}
 
-    VFD_writeString(string, colon_symbol);
+
+/**
+ * @brief Format a fixed-point number (used by VFD_writeFixed() of the display variants).
+ *      The number is right aligned and padded with spaces, there is at least 1 digit
+ *      before the point (Ex: "-0.05"). The point doesn't use a character.
+ *      If the number is too long, fractional digits are discarded until it fits;
+ *      if the integer part doesn't fit, the string is filled with '-'.
+ * @param string Buffer of width + 1 characters; null terminated.
+ * @param value Scaled integer: the displayed number is value / 10^frac_digits.
+ * @param frac_digits Number of digits after the point (0..9).
+ * @param width Number of characters, the minus sign included.
+ * @return Number of digits after the point in the string (0: no point).
+ */
+uint8_t VFD_formatFixed(char *string, int32_t value, uint8_t frac_digits, uint8_t width)
+{
+    bool     isNegative = value < 0;
+    uint32_t magnitude  = (isNegative) ? -(uint32_t)value : value;
+    char     digits[10];
+    uint8_t  length     = decimalDigits(magnitude, digits);
+    uint8_t  shown;
+
+    if (frac_digits > 9)
+        frac_digits = 9;
+
+    while (true) {
+        // Digits with the zeros before the significant ones (Ex: 0.05)
+        shown = (length > frac_digits) ? length : frac_digits + 1;
+        // No sign in front of a number truncated to 0
+        isNegative = isNegative && length;
+        if ((shown + isNegative <= width) || (frac_digits == 0))
+            break;
+        // Discard the last fractional digit
+        frac_digits--;
+        if (length)
+            length--;
+    }
+
+    string[width] = '\0';
+    if (shown + isNegative > width) {
+        // Overflow
+        while (width)
+            string[--width] = '-';
+        return 0;
+    }
+
+    // Fill from the right: significant digits, zeros, sign, then spaces
+    int8_t i = width - 1;
+    for (uint8_t n = 0; n < shown; n++, i--)
+    {
+        string[i] = (length) ? digits[--length] : '0';
+    }
+    if (isNegative)
+        string[i--] = '-';
+    while (i >= 0)
+        string[i--] = ' ';
+
+    return frac_digits;
+}
+
+
+/**
+ * @brief Display the part of a string that starts at the given shift.
+ *      VFD_DISPLAYABLE_DIGITS characters are written from the current grid cursor.
+ * @param string String to display; must be null terminated '\0'.
+ * @param left_shift Index of the first displayed character.
+ */
+static void scrollWindow(const char *string, uint8_t left_shift)
+{
+    // Copy the segment from original string to a temporary string
+    char    string_temp[VFD_DISPLAYABLE_DIGITS + 1] = "";
+    uint8_t temp_index = 0;
+
+    string += left_shift;
+    while ((temp_index < VFD_DISPLAYABLE_DIGITS) && (*string > '\0')) {
+        string_temp[temp_index] = *string;
+        temp_index++;
+        string++;
+    }
+    string_temp[temp_index] = '\0';
+
+    // Send the string to the controller
+    VFD_writeString(string_temp, false);
+    // Display the window with ENABLE_DOUBLE_BUFFER
+    VFD_present();
 }
 
 
 /**
  * @brief Scroll the given string on the display
- *      The speed can be adjusted by modifying VFD_SCROLL_SPEED define.
+ *      The speed can be adjusted by modifying VFD_SCROLL_DELAY define.
  * @param string String to display; must be null terminated '\0'.
  * @param pfunc (Optional) Callback called at the end of each scrolling iteration.
  *      It avoids blocking the program during the display loop.
@@ -281,28 +752,12 @@ void VFD_scrollText(const char *string, void(pfunc)())
 
     // Split the string into segments of the number of displayable characters,
     // then shift one letter at each iteration
-    char    string_temp[VFD_DISPLAYABLE_DIGITS + 1] = "";
     uint8_t left_shift = 0;
     while ((left_shift + VFD_DISPLAYABLE_DIGITS - 1) < size) {
-        // Copy the segment from original string to a temporary string
-        uint8_t temp_index = 0;
-        for (uint8_t i = left_shift; i < (left_shift + VFD_DISPLAYABLE_DIGITS); i++)
-        {
-            string_temp[temp_index] = string[i];
-            temp_index++;
-        }
-        string_temp[temp_index] = '\0';
-
-        // Send the string to the controller
-        VFD_writeString(string_temp, false);
-
-        // Reset/Update display
-        // => Don't know why but it appears to be mandatory to avoid forever black screen... (?)
-        // See VFD_busySpinningCircle() (same behavior)
-        VFD_resetDisplay();
+        scrollWindow(string, left_shift);
 
         if (left_shift == 0)
-             _delay_ms(1000);
+             _delay_ms(VFD_SCROLL_START_DELAY);
         else
              _delay_ms(VFD_SCROLL_DELAY);
 
@@ -315,17 +770,157 @@ void VFD_scrollText(const char *string, void(pfunc)())
         // Restore grid cursor
         // not on last iteration // todo PROPRE
         if ((left_shift + VFD_DISPLAYABLE_DIGITS - 1) < size) {
-            VFD_setGridCursor(cursor_save, false);
+            VFD_setGridCursor(cursor_save);
         }
     }
-    _delay_ms(2000);
+    _delay_ms(VFD_SCROLL_END_DELAY);
+}
+
+
+/**
+ * State of the non-blocking scroll engine
+ */
+static struct {
+    const char *string;     // Scrolled string (not copied)
+    uint8_t     size;       // Length of the string
+    uint8_t     left_shift; // Index of the next displayed window
+    uint8_t     cursor;     // Grid cursor where each window is written
+    uint16_t    delay;      // Pause after the last step (ms)
+    uint32_t    last_ms;    // Time of the last step
+    bool        running;
+} scroll;
+
+
+/**
+ * @brief Start to scroll the given string without blocking the program.
+ *      The scrolling is driven by VFD_scrollTick(); timings are the same as
+ *      VFD_scrollText(): VFD_SCROLL_START_DELAY on the first window,
+ *      VFD_SCROLL_DELAY between windows, VFD_SCROLL_END_DELAY at the end.
+ *      The current grid cursor is used as the position of the text.
+ * @param string String to display; must be null terminated '\0'.
+ * @warning The string is not copied: it MUST stay valid until the end of the scrolling.
+ */
+void VFD_scrollStart(const char *string)
+{
+    scroll.string     = string;
+    scroll.size       = 0;
+    scroll.left_shift = 0;
+    scroll.cursor     = grid_cursor;
+    scroll.delay      = 0;
+    scroll.running    = true;
+
+    while (string[scroll.size] > '\0') {
+        scroll.size++;
+    }
+}
+
+
+/**
+ * @brief Advance the scrolling started by VFD_scrollStart() if its pause is over.
+ *      At most 1 window is displayed per call; the function never waits.
+ * @param now_ms Current time in milliseconds (i.e. millis()).
+ *      Overflows of the counter are supported.
+ * @return true while the scrolling is running, false once it is over.
+ */
+bool VFD_scrollTick(uint32_t now_ms)
+{
+    if (!scroll.running)
+        return false;
+
+    if ((scroll.left_shift > 0) && ((uint32_t)(now_ms - scroll.last_ms) < scroll.delay))
+        return true;
+
+    scroll.last_ms = now_ms;
+
+    if ((scroll.left_shift == 0) || ((scroll.left_shift + VFD_DISPLAYABLE_DIGITS - 1) < scroll.size)) {
+        // Next window; a string shorter than the display is shown once
+        VFD_setGridCursor(scroll.cursor);
+        scrollWindow(scroll.string, scroll.left_shift);
+        scroll.delay = (scroll.left_shift == 0) ? VFD_SCROLL_START_DELAY : VFD_SCROLL_DELAY;
+        scroll.left_shift++;
+    } else if (scroll.delay != VFD_SCROLL_END_DELAY) {
+        // Last window has been displayed long enough: final pause
+        scroll.delay = VFD_SCROLL_END_DELAY;
+    } else {
+        scroll.running = false;
+    }
+    return scroll.running;
+}
+
+
+/**
+ * @brief Stop the scrolling started by VFD_scrollStart().
+ *      The current window stays on the display.
+ */
+void VFD_scrollStop(void)
+{
+    scroll.running = false;
+}
+
+
+/**
+ * @brief Display 1 refresh of an animation stored in flash memory.
+ *      The bytes of the animation are rebuilt from the elements of the current frame
+ *      whose period divides loop_number (a period of 0 counts as 1); they are sent if they are modified,
+ *      without the other pending bytes of the framebuffer (see VFD_flushRange()):
+ *      this function can be called from an interrupt (see VFD_spinnerRefresh()).
+ *      The refreshes are counted in loop_number, the next frame is taken once the
+ *      number of refreshes per frame (header of the animation) is reached.
+ *      If ENABLE_ICON_BUFFER is enabled, the icons of the bytes are preserved.
+ * @param animation Frames in flash memory (PROGMEM), see VFD_ANIM_ELEMENT().
+ * @param address Memory address of the 1st byte of the animation.
+ * @param frame_number Current frame to display (Value range 1..number of frames);
+ *      This value is updated when the frame is modified.
+ *      The frame number goes back to 1 after the last frame.
+ * @param loop_number Number of refreshes for a frame; used to set the duty cycle of the elements.
+ *      This value is incremented at each call.
+ */
+void VFD_playFrame(const uint8_t *animation, uint8_t address, uint8_t &frame_number, uint8_t &loop_number)
+{
+    uint8_t bytes[VFD_ANIM_MAX_BYTES] = {0};
+    const uint8_t *element = animation + VFD_ANIM_HEADER_SIZE;
+    uint8_t attributes;
+
+    // Skip the elements of the previous frames
+    for (uint8_t frame = 1; frame < frame_number; element += 2) {
+        if (pgm_read_byte(element) & VFD_ANIM_LAST)
+            frame++;
+    }
+
+    do {
+        attributes = pgm_read_byte(element);
+        uint8_t period = attributes & VFD_ANIM_PERIOD_MSK;
+        // A period of 0 (table not built with the macros) is treated as 1
+        if ((period <= 1) || ((loop_number % period) == 0)) {
+            bytes[(attributes >> VFD_ANIM_BYTE_POS) & (VFD_ANIM_MAX_BYTES - 1)] |= pgm_read_byte(element + 1);
+        }
+        element += 2;
+    } while (!(attributes & VFD_ANIM_LAST));
+
+    loop_number++;
+    if (loop_number == pgm_read_byte(&animation[1])) {
+        frame_number = (frame_number == pgm_read_byte(&animation[0])) ? 1 : frame_number + 1;
+        loop_number  = 0;
+    }
+
+    uint8_t size = pgm_read_byte(&animation[2]);
+    for (uint8_t i = 0; i < size; i++) {
+        #if ENABLE_ICON_BUFFER == 1
+        VFD_setBufferByte(address + i, bytes[i] | iconDisplayBuffer[address + i]);
+        #else
+        VFD_setBufferByte(address + i, bytes[i]);
+        #endif
+    }
+    // Only the bytes of the animation: the program may be drawing in the framebuffer
+    VFD_flushRange(address, size);
 }
 
 
 /**
  * @brief Wrapper to VFD_busySpinningCircle(), handle delay between frames and callback.
  *      Delay can be adjusted by modifying the define VFD_BUSY_DELAY.
- * @param address Address (range 0x00..0x15 (22 addresses)) or position (range 1 to number of grids)
+ * @param address Address (range 0..PT6312_DISPLAY_MEM - 1, i.e. 2 * VFD_GRIDS addresses;
+ *      others are ignored) or position (range 1 to number of grids)
  *      passed to VFD_busySpinningCircle(). The use of this variable in this later function
  *      defines its signification (memory address vs grid number).
  * @param pfunc (Optional) Callback called at the end of each frame change.
@@ -353,6 +948,108 @@ void VFD_busyWrapper(uint8_t address, void(pfunc)())
 }
 
 
+/**
+ * State of the spinner service
+ */
+static struct {
+    volatile bool  running;
+    const uint8_t *animation;   // Played animation; nullptr: VFD_busySpinningCircle()
+    uint8_t        address;     // Address or position passed to VFD_busySpinningCircle()
+    uint8_t        frame_number;
+    uint8_t        loop_number;
+    uint32_t       last_us;     // Time of the last refresh
+} spinner;
+
+
+/**
+ * @brief Start the spinning circle animation in the background.
+ *      Frames are advanced by VFD_spinnerRefresh() (from a timer interrupt)
+ *      or VFD_spinnerTick() (from the main loop); the program is never blocked.
+ * @param address Address or position passed to VFD_busySpinningCircle().
+ * @see VFD_busyWrapper()
+ */
+void VFD_spinnerStart(uint8_t address)
+{
+    VFD_animationStart(nullptr, address);
+}
+
+
+/**
+ * @brief Play an animation in the background, in place of the spinning circle.
+ *      It is driven by the spinner service: VFD_animationRefresh() (from a timer
+ *      interrupt) or VFD_animationTick() (from the main loop), stopped by VFD_animationStop().
+ * @param animation Frames in flash memory (PROGMEM), see VFD_playFrame().
+ * @param address Memory address of the 1st byte of the animation.
+ */
+void VFD_animationStart(const uint8_t *animation, uint8_t address)
+{
+    spinner.running      = false;
+    spinner.animation    = animation;
+    spinner.address      = address;
+    spinner.frame_number = 1;
+    spinner.loop_number  = 0;
+    spinner.running      = true;
+}
+
+
+/**
+ * @brief Stop the spinning circle animation.
+ *      The last frame stays on the display.
+ */
+void VFD_spinnerStop(void)
+{
+    spinner.running = false;
+}
+
+
+/**
+ * @brief Refresh the spinning circle once; to be called every VFD_SPINNER_PERIOD_US.
+ *      A full loop of the animation is made in 420 refreshes, the fading segments keep
+ *      their 1/2, 1/5 and 1/12 duty cycles.
+ *      This function can be called from a timer compare interrupt:
+ *      the refresh is skipped if a transmission with the controller is in progress
+ *      (CS/Strobe LOW), and the grid cursor of the program is preserved.
+ *      Only the bytes of the animation are sent: the bytes that the program has
+ *      written in the framebuffer but not flushed yet stay pending.
+ *      With ENABLE_DOUBLE_BUFFER, the animation is displayed without VFD_present().
+ */
+void VFD_spinnerRefresh(void)
+{
+    if (!spinner.running || !VFD_transportIdle())
+        return;
+
+    if (spinner.animation != nullptr) {
+        VFD_playFrame(spinner.animation, spinner.address, spinner.frame_number, spinner.loop_number);
+        return;
+    }
+
+    uint8_t cursor_save = grid_cursor;
+    VFD_busySpinningCircle(spinner.address, spinner.frame_number, spinner.loop_number);
+    grid_cursor = cursor_save;
+}
+
+
+/**
+ * @brief Refresh the spinning circle if VFD_SPINNER_PERIOD_US is elapsed
+ *      since the last refresh; to be called as often as possible from the main loop.
+ * @param now_us Current time in microseconds (i.e. micros()).
+ *      Overflows of the counter are supported.
+ * @return true while the spinner is running.
+ */
+bool VFD_spinnerTick(uint32_t now_us)
+{
+    if (!spinner.running)
+        return false;
+
+    if ((uint32_t)(now_us - spinner.last_us) >= VFD_SPINNER_PERIOD_US) {
+        // Late refreshes are not caught up
+        spinner.last_us = now_us;
+        VFD_spinnerRefresh();
+    }
+    return true;
+}
+
+
 /**
  * @brief Set status of LEDs.
  *      Up to 4 LEDs can be controlled.
@@ -364,26 +1061,7 @@ void VFD_busyWrapper(uint8_t address, void(pfunc)())
  */
 void VFD_setLEDs(uint8_t leds)
 {
-    // Enable LED Read mode
-    // Data set cmd, normal mode, auto incr, write data to LED port
-    VFD_command(PT6312_DATA_SET_CMD | PT6312_MODE_NORM | PT6312_ADDR_INC | PT6312_LED_WR, false);
-
-    // Invert the bits:
-    // 0: LED lights
-    // 1: LED turns off
-    for (uint8_t i = 0; i < 8; i++)
-    {
-        if ((1 << i) & leds) {
-            // Bit is set: Clear the bit
-            leds &= ~(1 << i);
-        }
-    }
-
-    VFD_command(leds & PT6312_LED_MSK, true);
-
-    // Restore Data Write mode
-    // Data set cmd, normal mode, auto incr, write data to memory
-    VFD_command(PT6312_DATA_SET_CMD | PT6312_MODE_NORM | PT6312_ADDR_INC | PT6312_DATA_WR, true);
+    VFD_Driver::writeLEDs(leds);
 }
 
 
@@ -404,33 +1082,7 @@ void VFD_setLEDs(uint8_t leds)
  */
 uint32_t VFD_getKeys(void)
 {
-    // Enable Key Read mode
-    // Data set cmd, normal mode, auto incr, read data
-    VFD_command(PT6312_DATA_SET_CMD | PT6312_MODE_NORM | PT6312_ADDR_INC | PT6312_KEY_RD, false);
-
-    // Configure DATA pin input HIGH
-    _pinMode(VFD_DATA_DDR, VFD_DATA_PIN, _INPUT);
-    _digitalWrite(VFD_DATA_PORT, VFD_DATA_PIN, _HIGH);
-
-    // Here: CS is still LOW, SCLK is still HIGH
-    _delay_us(1);
-
-    // Read the key matrix of size PT6312_KEY_MEM bytes
-    // 3 bytes = 3 readings
-    uint32_t raw_keys = PT6312_KEY_MSK & VFD_readByte();
-    raw_keys = (raw_keys << 8) + (PT6312_KEY_MSK & VFD_readByte());
-    raw_keys = (raw_keys << 8) + (PT6312_KEY_MSK & VFD_readByte());
-
-    // Restore DATA pin as OUTPUT
-    _pinMode(VFD_DATA_DDR, VFD_DATA_PIN, _OUTPUT);
-
-    VFD_CSSignal();
-
-    // Restore Data Write mode
-    // Data set cmd, normal mode, auto incr, write data to memory
-    VFD_command(PT6312_DATA_SET_CMD | PT6312_MODE_NORM | PT6312_ADDR_INC | PT6312_DATA_WR, true);
-
-    return raw_keys;
+    return VFD_Driver::readKeys();
 }
 
 
@@ -449,8 +1101,8 @@ uint8_t VFD_getKeyPressed(void)
     // Get 1 sample (6th sample): Last 4 bits of the uint32_t
     pressed_btn = PT6312_KEY_SMPL_MSK & PT6312_KEY_MSK & VFD_getKeys();
     if (pressed_btn > 0) {
-        // Return the button number
-        while (((1 << btn_nr) & pressed_btn) == 0) {
+        // Return the button number (button 0 is the bit 0)
+        while (((1 << (btn_nr - 1)) & pressed_btn) == 0) {
             btn_nr++;
         }
         return btn_nr;
@@ -460,38 +1112,187 @@ uint8_t VFD_getKeyPressed(void)
 
 
 /**
- * @brief Get status of switches
- *      Switches status are stored in the last 4 bits of the returned byte.
- *      The first (lowest) bit represents switch 0.
- *      Ex: 0b....0001
- *                   |
- *                   switch 0 is pressed
+ * @brief Read the whole key matrix in 1 transmission and compute the edges.
+ *      All the key queries of a frame can be answered from the scan:
+ *          held:        scan.state & VFD_KEY_BIT(sample, key)
+ *          new press:   scan.pressed & VFD_KEY_BIT(sample, key)
+ *          chord:       VFD_chordPressed(&scan, VFD_KEY_BIT(0, 0) | VFD_KEY_BIT(0, 1))
+ * @param scan State of the previous scan (zero initialized before the first one);
+ *      updated with the new state and the keys pressed/released since the previous scan.
+ * @see VFD_getKeys() for the layout of the bits.
  */
-uint8_t VFD_getSwitches(void)
+void VFD_scanKeys(vfd_key_scan_t *scan)
+{
+    uint32_t state = VFD_getKeys();
+
+    scan->pressed  = state & ~scan->state;
+    scan->released = scan->state & ~state;
+    scan->state    = state;
+}
+
+
+// Durations of the key service in number of polls
+#define VFD_KEY_LONG_PRESS_POLLS    (VFD_KEY_LONG_PRESS_MS / VFD_KEY_POLL_PERIOD_MS)
+#define VFD_KEY_REPEAT_POLLS        (VFD_KEY_REPEAT_MS / VFD_KEY_POLL_PERIOD_MS)
+
+#if (VFD_KEY_QUEUE_SIZE & (VFD_KEY_QUEUE_SIZE - 1)) || (VFD_KEY_QUEUE_SIZE > 128)
+    #error "VFD_KEY_QUEUE_SIZE must be a power of 2 (max 128)"
+#endif
+
+/**
+ * State of the key service
+ */
+static struct {
+    volatile vfd_key_event_t events[VFD_KEY_QUEUE_SIZE];
+    volatile uint8_t head;                  // Next event to write (key service)
+    volatile uint8_t tail;                  // Next event to read (VFD_pollKeyEvent())
+    uint8_t          voted;                 // Keys pressed in most of the samples of the last poll
+    uint8_t          candidate;             // Keys waiting for VFD_KEY_DEBOUNCE_POLLS stable polls
+    uint8_t          stable_polls;
+    uint8_t          pressed;               // Debounced keys
+    uint16_t         held_polls[VFD_KEYS];  // Polls since the press of each key
+    uint32_t         last_ms;               // Time of the last poll
+} keys;
+
+
+/**
+ * @brief Push an event in the queue; the event is dropped if the queue is full.
+ */
+static void pushKeyEvent(uint8_t type, uint8_t key)
+{
+    uint8_t head = keys.head;
+    uint8_t next = (head + 1) & (VFD_KEY_QUEUE_SIZE - 1);
+
+    if (next == keys.tail)
+        return;
+
+    keys.events[head].type = type;
+    keys.events[head].key  = key;
+    keys.head = next;
+}
+
+
+/**
+ * @brief Poll the keys once; to be called every VFD_KEY_POLL_PERIOD_MS.
+ *      Each key is voted on the 6 samples of the key matrix (see VFD_getKeys()):
+ *      pressed in 4 samples or more, released in 2 or less, unchanged otherwise.
+ *      A change of the voted keys is accepted after VFD_KEY_DEBOUNCE_POLLS
+ *      identical polls; it pushes VFD_KEY_PRESS and VFD_KEY_RELEASE events.
+ *      A key held for VFD_KEY_LONG_PRESS_MS pushes a VFD_KEY_LONG_PRESS event,
+ *      then a VFD_KEY_REPEAT event every VFD_KEY_REPEAT_MS.
+ *      The latency of an event is VFD_KEY_DEBOUNCE_POLLS * VFD_KEY_POLL_PERIOD_MS at most
+ *      (+1 poll); it doesn't depend on the main loop if the service is called
+ *      from a timer compare interrupt.
+ *      The poll is skipped if a transmission with the controller is in progress
+ *      (CS/Strobe LOW).
+ * @see VFD_pollKeyEvent()
+ */
+void VFD_keyService(void)
 {
-    // Enable Switch Read mode
-    // Data set cmd, normal mode, auto incr, read data
-    VFD_command(PT6312_DATA_SET_CMD | PT6312_MODE_NORM | PT6312_ADDR_INC | PT6312_SW_RD, false);
+    if (!VFD_transportIdle())
+        return;
 
-    // Make DATA pin input HIGH
-    _pinMode(VFD_DATA_DDR, VFD_DATA_PIN, _INPUT);
-    _digitalWrite(VFD_DATA_PORT, VFD_DATA_PIN, _HIGH);
+    uint32_t raw_keys = VFD_getKeys();
+    uint8_t  voted    = 0;
 
-    // Here: CS is still LOW, SCLK is still HIGH
-    _delay_us(1);
+    // The interrupted program may be between a check of the write mode and a write
+    VFD_Driver::restoreWriteMode();
 
-    uint8_t raw_switches = PT6312_SW_MSK & VFD_readByte();
+    for (uint8_t key = 0; key < VFD_KEYS; key++) {
+        uint8_t votes = 0;
+        for (uint8_t sample = 0; sample < 6; sample++) {
+            votes += (raw_keys >> (sample * 4 + key)) & 1;
+        }
+        if ((votes >= 4) || ((votes == 3) && (keys.voted & (1 << key))))
+            voted |= 1 << key;
+    }
+    keys.voted = voted;
+
+    // Debounce
+    if (voted != keys.candidate) {
+        keys.candidate    = voted;
+        keys.stable_polls = 1;
+    } else if (keys.stable_polls < VFD_KEY_DEBOUNCE_POLLS) {
+        keys.stable_polls++;
+    }
+
+    uint8_t changed = (keys.stable_polls >= VFD_KEY_DEBOUNCE_POLLS) ? keys.pressed ^ keys.candidate : 0;
+
+    for (uint8_t key = 0; key < VFD_KEYS; key++) {
+        uint8_t mask = 1 << key;
+
+        if (changed & mask) {
+            if (keys.candidate & mask) {
+                keys.held_polls[key] = 0;
+                pushKeyEvent(VFD_KEY_PRESS, key + 1);
+            } else {
+                pushKeyEvent(VFD_KEY_RELEASE, key + 1);
+            }
+        } else if (keys.pressed & mask) {
+            uint16_t held = ++keys.held_polls[key];
+            if (held == VFD_KEY_LONG_PRESS_POLLS) {
+                pushKeyEvent(VFD_KEY_LONG_PRESS, key + 1);
+            } else if (held == VFD_KEY_LONG_PRESS_POLLS + VFD_KEY_REPEAT_POLLS) {
+                keys.held_polls[key] = VFD_KEY_LONG_PRESS_POLLS;
+                pushKeyEvent(VFD_KEY_REPEAT, key + 1);
+            }
+        }
+    }
+    keys.pressed ^= changed;
+}
+
+
+/**
+ * @brief Poll the keys if VFD_KEY_POLL_PERIOD_MS is elapsed since the last poll;
+ *      to be called as often as possible from the main loop.
+ * @param now_ms Current time in milliseconds (i.e. millis()).
+ *      Overflows of the counter are supported.
+ * @return true if the keys have been polled.
+ * @see VFD_keyService()
+ */
+bool VFD_keyTick(uint32_t now_ms)
+{
+    if ((uint32_t)(now_ms - keys.last_ms) < VFD_KEY_POLL_PERIOD_MS)
+        return false;
+
+    // Late polls are not caught up
+    keys.last_ms = now_ms;
+    VFD_keyService();
+    return true;
+}
+
+
+/**
+ * @brief Get the oldest key event without blocking.
+ * @param event Filled with the event if there is one.
+ * @return false if the queue is empty.
+ * @see VFD_keyService()
+ */
+bool VFD_pollKeyEvent(vfd_key_event_t *event)
+{
+    uint8_t tail = keys.tail;
 
-    // DATA pin as OUTPUT
-    _pinMode(VFD_DATA_DDR, VFD_DATA_PIN, _OUTPUT);
+    if (tail == keys.head)
+        return false;
 
-    VFD_CSSignal();
+    event->type = keys.events[tail].type;
+    event->key  = keys.events[tail].key;
+    keys.tail = (tail + 1) & (VFD_KEY_QUEUE_SIZE - 1);
+    return true;
+}
 
-    // Restore Data Write mode
-    // Data set cmd, normal mode, auto incr, write data to memory
-    VFD_command(PT6312_DATA_SET_CMD | PT6312_MODE_NORM | PT6312_ADDR_INC | PT6312_DATA_WR, true);
 
-    return raw_switches;
+/**
+ * @brief Get status of switches
+ *      Switches status are stored in the last 4 bits of the returned byte.
+ *      The first (lowest) bit represents switch 0.
+ *      Ex: 0b....0001
+ *                   |
+ *                   switch 0 is pressed
+ */
+uint8_t VFD_getSwitches(void)
+{
+    return VFD_Driver::readSwitches();
 }
 
 
@@ -514,7 +1315,7 @@ void VFD_segmentsGenericTest(void)
 {
     // msb: segments 16-9
     // lsb: segments 8-1
-    uint8_t msb = 0, lsb = 0;
+    uint8_t msb = 0, lsb = 0, address;
 
     // Para depuração dos nomes dos segmentos.
     //Serial.println("--- Inicio ---");
@@ -522,8 +1323,7 @@ void VFD_segmentsGenericTest(void)
     for (uint8_t grid = 1; grid <= VFD_GRIDS; grid++)
     {
         VFD_clear();
-        // Note: VFD_SEGMENTS is defined in VFD_resetDisplay()
-        for (uint8_t i = 0; i < VFD_SEGMENTS; i++)
+        for (uint8_t i = 0; i < VFD_Geometry<VFD_GRIDS>::segments; i++)
         {
             if (i < 8) {
                 lsb = 1 << i;
@@ -533,11 +1333,11 @@ void VFD_segmentsGenericTest(void)
                 lsb = 0;
             }
 
-            // Set grid
-            VFD_setGridCursor(grid, false);
-            // Set segments
-            VFD_command(lsb, false);
-            VFD_command(msb, true);
+            // Set segments of the grid
+            address = (grid * PT6312_BYTES_PER_GRID) - PT6312_BYTES_PER_GRID;
+            VFD_setBufferByte(address, lsb);
+            VFD_setBufferByte(address + 1, msb);
+            VFD_present();
 
             /*
             // Para depuração dos nomes dos segmentos.
@@ -558,7 +1358,7 @@ void VFD_segmentsGenericTest(void)
         }
         VFD_clear();
         // Para depuração dos nomes dos segmentos.
-        Serial.println("    --- FIM GRID ---");
+        //Serial.println("    --- FIM GRID ---");
     }
     // Para depuração dos nomes dos segmentos.
     //Serial.println();
@@ -573,21 +1373,13 @@ void VFD_segmentsGenericTest(void)
  */
 void VFD_displayAllSegments(void)
 {
-    VFD_setGridCursor(1, false);
-    for (uint8_t grid = 1; grid <= VFD_GRIDS; grid++)
+    for (uint8_t i = 0; i < PT6312_DISPLAY_MEM; i++)
     {
-        // Display a segment
-        VFD_command(255, false);
-        VFD_command(255, false);
+        VFD_setBufferByte(i, 255);
     }
-    VFD_CSSignal();
+    VFD_present();
 
     grid_cursor = VFD_GRIDS;
-
-    // Reset/Update display
-    // => Don't know why but it appears to be mandatory to avoid forever black screen... (?)
-    // See VFD_busySpinningCircle() (same behavior)
-    VFD_resetDisplay();
 }
 
 
@@ -603,7 +1395,7 @@ void VFD_displayAllFontGlyphes(void)
     for (i = 0; i < arrayLength; i++)
     {
         // Do not display N/A chars
-        if ((FONT[i][0] | FONT[i][1]) > 0) {
+        if (VFD_fontGlyph(i + 0x20) > 0) {
             string[j] = i + 0x20;
             j++;
         }
@@ -612,41 +1404,6 @@ void VFD_displayAllFontGlyphes(void)
 }
 
 
-/**
- * @brief Send a byte in a write command to the controller
- * @param value Byte to send.
- * @param cmd (Optional)
- *      If True, the CS/Strobe line is asserted to HIGH (end of transmission)
- *      after the byte has been sent.
- *      Default: false
- */
-void VFD_command(uint8_t value, bool cmd)
-{
-    _digitalWrite(VFD_CS_PORT, VFD_CS_PIN, _LOW);
-    _delay_us(1); // NOTE: not in datasheet
-
-    for (uint8_t i = 0; i < 8; i++)
-    {
-        _digitalWrite(VFD_SCLK_PORT, VFD_SCLK_PIN, _LOW);
-
-        if (value & (1 << i)) {
-            _digitalWrite(VFD_DATA_PORT, VFD_DATA_PIN, _HIGH);
-        }else{
-            _digitalWrite(VFD_DATA_PORT, VFD_DATA_PIN, _LOW);
-        }
-        // wait 500ns
-        _delay_us(0.5);
-        // Data is read at the rising edge
-        _digitalWrite(VFD_SCLK_PORT, VFD_SCLK_PIN, _HIGH);
-        _delay_us(0.5);
-    }
-
-    if (cmd) {
-        VFD_CSSignal();
-    }
-}
-
-
 /**
  * @brief Signal the driver that the data transmission is over
  *      The CS/Strobe line is asserted to HIGH (end of transmission).
@@ -654,41 +1411,13 @@ void VFD_command(uint8_t value, bool cmd)
 extern inline void VFD_CSSignal();
 
 
-/**
- * @brief Obtain a byte from the controller (i.e get keys & switches status)
- * @see VFD_getSwitches(), VFD_getKeys(), VFD_getKeyPressed().
- * @return Byte of data
- */
-uint8_t VFD_readByte(void)
-{
-    uint8_t data_in = 0xFF;
-
-    for (uint8_t i = 0; i < 8; i++)
-    {
-        _digitalWrite(VFD_SCLK_PORT, VFD_SCLK_PIN, _LOW);
-        _delay_us(0.5);
-
-        // Data is read at the falling edge
-        // DigitalRead (read only) of VFD_DATA_PIN status
-        if (bit_is_set(VFD_DATA_R_ONLY_PORT, VFD_DATA_PIN) == 0) {
-            // Bit is not set: Clear the bit
-            data_in &= ~(1 << i);
-        }
-
-        _digitalWrite(VFD_SCLK_PORT, VFD_SCLK_PIN, _HIGH);
-        _delay_us(0.5);
-    }
-    return data_in;
-}
-
-
 /**
  * @brief Write a specific byte at the given address in the controller memory.
  *      This function doesn't use VFD_setGridCursor() to map the position
  *      to a grid.
- * @warning Note that the CS/Strobe line is asserted to HIGH (end of transmission)
- *      after the byte has been sent.
- * @param address Value range 0x00..0x15 (22 addresses).
+ *      The byte goes through the shadow framebuffer: it is sent only if
+ *      its value differs from the one already in the controller.
+ * @param address Value range 0..PT6312_DISPLAY_MEM - 1.
  * @param data Byte to write at the given address.
  * @warning Since a specific address is used, the grid_cursor global variable IS NOT updated,
  *      and is thus more synchronized with the controller memory.
@@ -697,8 +1426,46 @@ uint8_t VFD_readByte(void)
  */
 void VFD_writeByte(uint8_t address, char data)
 {
-    VFD_command(PT6312_ADDR_SET_CMD | (address & PT6312_ADDR_MSK), false);
-    VFD_command(data, true);
+    VFD_setBufferByte(address, data);
+    VFD_flush();
+}
+
+
+/**
+ * @brief Modify some segments of 1 or 2 consecutive bytes in the controller memory;
+ *      the other segments are preserved.
+ *      The bytes go through the shadow framebuffer: only the modified bytes are
+ *      sent, in 1 transmission (address + data: 2 bytes on the wire for 1 byte).
+ *      Like VFD_flushRange(), the other pending bytes of the framebuffer are
+ *      left untouched; the addressed bytes are displayed at once, even with
+ *      ENABLE_DOUBLE_BUFFER. A byte whose mask is 0 is neither modified nor sent
+ *      (a mask of 0 sends nothing).
+ * @param address Value range 0..PT6312_DISPLAY_MEM - 1. Other addresses
+ *      (i.e. VFD_RENDER_NONE) are ignored.
+ * @param mask Segments to modify: LSB for the byte at the address, MSB for the next one.
+ * @param value New state of the segments of the mask (same layout as mask).
+ * @warning The grid_cursor global variable IS NOT updated (see VFD_writeByte()).
+ */
+void VFD_writeBytesAt(uint8_t address, uint16_t mask, uint16_t value)
+{
+    if ((address >= PT6312_DISPLAY_MEM) || (mask == 0))
+        return;
+
+    // Range of the bytes with segments to modify
+    uint8_t first = 0, len = 0;
+
+    for (uint8_t i = 0; (i < 2) && (address < PT6312_DISPLAY_MEM); i++, address++) {
+        if ((uint8_t)mask) {
+            VFD_setBufferByte(address, (displayBuffer[address] & ~mask) | (value & mask));
+            if (len == 0)
+                first = address;
+            len = address - first + 1;
+        }
+        mask  >>= 8;
+        value >>= 8;
+    }
+    if (len)
+        VFD_flushRange(first, len);
 }
 
 
@@ -717,8 +1484,8 @@ void VFD_setIcon(uint8_t icon_font_index)
     // Get memory address from grid
     // Grid obtained starts from 0
     // Ex: for grid=1: (1+1)*2-2 = 2
-    uint8_t addr    = convertGridToMemoryAddress(ICONS_FONT[icon_font_index] & 0x0F);
-    uint8_t segment = ICONS_FONT[icon_font_index] >> 4;
+    uint8_t addr    = convertGridToMemoryAddress(VFD_iconLocation(icon_font_index) & 0x0F);
+    uint8_t segment = VFD_iconLocation(icon_font_index) >> 4;
 
     // Address in iconDisplayBuffer is depends on the localization of the segment
     // (LSB or MSB)
@@ -744,8 +1511,8 @@ void VFD_clearIcon(uint8_t icon_font_index)
     // Get memory address from grid
     // Grid obtained starts from 0
     // Ex: for grid=1: (1+1)*2-2 = 2
-    uint8_t addr    = convertGridToMemoryAddress(ICONS_FONT[icon_font_index] & 0x0F);
-    uint8_t segment = ICONS_FONT[icon_font_index] >> 4;
+    uint8_t addr    = convertGridToMemoryAddress(VFD_iconLocation(icon_font_index) & 0x0F);
+    uint8_t segment = VFD_iconLocation(icon_font_index) >> 4;
 
     // Address in iconDisplayBuffer is depends on the localization of the segment
     // (LSB or MSB)
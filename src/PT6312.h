@@ -21,9 +21,15 @@
 #ifndef ET16312N_H
 #define ET16312N_H
 
+#include <global.h>
+#if defined(VFD_TRANSPORT_HOST)
+#include "host/host_pins.h"
+#include "host/host_pgmspace.h"
+#else
 #include <avr/io.h>
+#include <avr/pgmspace.h>
 #include <util/delay.h>
-#include <global.h>
+#endif
 
 
 /**
@@ -53,6 +59,8 @@
 
 // Reserved bits for commands
 #define PT6312_CMD_MSK           0xE0
+// Bits of the command type (mode/data/display control/address setting)
+#define PT6312_CMD_TYPE_MSK      0xC0
 
 // Mode setting command
 #define PT6312_MODE_SET_CMD      0x00
@@ -71,6 +79,7 @@
 #define PT6312_LED_WR            0x01
 #define PT6312_KEY_RD            0x02
 #define PT6312_SW_RD             0x03
+#define PT6312_DATA_RD_MSK       0x03
 #define PT6312_ADDR_INC          0x00
 #define PT6312_ADDR_FIXED        0x04
 #define PT6312_MODE_NORM         0x00
@@ -125,7 +134,7 @@
 // Generic shortcuts
 #define VFD_displayOn(BRIGHTNESS)    VFD_setBrightness(BRIGHTNESS)
 #define VFD_displayOff()             VFD_command(PT6312_DSP_CTRL_CMD | PT6312_DSP_OFF | PT6312_BRT0, true)
-#define VFD_home()                   VFD_setGridCursor(1, false)
+#define VFD_home()                   VFD_setGridCursor(1)
 
 // Shortcuts for write functions
 #define VFD_writeStringPosition(string, position, colon_symbol) \
@@ -140,11 +149,23 @@
         VFD_writeInt(number, digits_number, colon_symbol);                  \
     }
 
+#include "transport.h"
+#include "PT6312_config.h"
+
+// Dirty bitmap of the shadow framebuffer: 1 bit per byte of display memory
+typedef VFD_DirtyMask<PT6312_DISPLAY_MEM>::type vfd_dirty_t;
+
 /**
  * Global variables
  */
 // Grid cursor (starting from 1)
 extern uint8_t grid_cursor;
+// Shadow framebuffer: RAM mirror of the display memory of the controller
+extern uint8_t displayBuffer[PT6312_DISPLAY_MEM];
+extern vfd_dirty_t dirty_mask;
+#if ENABLE_DOUBLE_BUFFER == 1
+extern uint8_t frontBuffer[PT6312_DISPLAY_MEM];
+#endif
 
 /**
  * Generic API
@@ -154,15 +175,98 @@ void VFD_resetDisplay(void);
 void VFD_setBrightness(const uint8_t brightness);
 void VFD_clear(void);
 
+/**
+ * Brightness fade
+ */
+#define VFD_FADE_MAX  (PT6312_BRT7 * VFD_FADE_STEPS) // Level of the brightness 7
+void VFD_fadeTo(uint8_t level, uint16_t duration_ms);
+void VFD_fadeStop(void);
+void VFD_fadeRefresh(void);
+bool VFD_fadeTick(uint32_t now_ms);
+
+/**
+ * Shadow framebuffer
+ */
+void VFD_setBufferByte(uint8_t address, uint8_t data);
+void VFD_flush(void);
+void VFD_flushRange(uint8_t address, uint8_t len);
+void VFD_invalidate(void);
+void VFD_present(void);
+
 /**
  * Display functions
  */
-void VFD_setGridCursor(uint8_t position, bool cmd=false);
+void VFD_setGridCursor(uint8_t position);
 void VFD_writeString(const char *string, bool colon_symbol); // Adapted if ENABLE_ICON_BUFFER is set
 void VFD_writeInt(int32_t number, int8_t digits_number, bool colon_symbol);
+void VFD_writeFixed(int32_t value, uint8_t frac_digits, uint8_t width); // Adapted to the display variant
+void VFD_writeCharAt(uint8_t position, char character); // Adapted to the display variant
+uint8_t VFD_formatFixed(char *string, int32_t value, uint8_t frac_digits, uint8_t width);
+uint8_t VFD_formatInt(char *string, int32_t number, int8_t digits_number, uint8_t position);
+
+// Text rendered in bytes, without framebuffer (see VFD_renderString() & PT6312Display)
+#define VFD_RENDER_MAX_BYTES    22   // Display memory of the largest geometry (11 grids)
+#define VFD_RENDER_NONE         0xFF // No byte to modify (see VFD_renderCharAt())
+uint8_t VFD_renderString(uint8_t *bytes, const char *string, bool colon_symbol, uint8_t &position); // Adapted to the display variant
+// position of VFD_renderCharAt() & VFD_writeCharAt(): character from the left of the display
+// (1: 1st character), whatever the grid cursor
+uint8_t VFD_renderCharAt(uint8_t position, char character, uint16_t &mask, uint16_t &value); // Adapted to the display variant
 void VFD_busySpinningCircle(uint8_t address, uint8_t &frame_number, uint8_t &loop_number); // Adapted if ENABLE_ICON_BUFFER is set
 void VFD_busyWrapper(uint8_t address, void (pfunc)()=nullptr);
+void VFD_spinnerStart(uint8_t address);
+void VFD_spinnerStop(void);
+void VFD_spinnerRefresh(void);
+bool VFD_spinnerTick(uint32_t now_us);
+
+/**
+ * Animations stored in flash memory (see VFD_playFrame())
+ * Header of 3 bytes: number of frames, refreshes per frame, bytes of display
+ * memory used (1..4), followed by the elements of the frames (2 bytes each).
+ * An element is a set of segments of 1 byte, displayed 1 refresh out of
+ * `period` (1: always, 2: 1/2 duty cycle, etc. up to 31); a frame is made of the elements
+ * up to the one flagged as the last (VFD_ANIM_LAST_ELEMENT()).
+ *
+ * Ex: Blinking segment 16 of the MSB of a grid (2 frames of 250 refreshes):
+ *      const uint8_t BLINK[] PROGMEM = {
+ *          2, 250, 1,
+ *          VFD_ANIM_LAST_ELEMENT(0, 1, 1 << (16 - 8 - 1)),
+ *          VFD_ANIM_LAST_ELEMENT(0, 1, 0),
+ *      };
+ */
+#define VFD_ANIM_HEADER_SIZE  3
+#define VFD_ANIM_MAX_BYTES    4
+#define VFD_ANIM_LAST         0x80 // Last element of a frame
+#define VFD_ANIM_BYTE_POS     5    // Byte offset (from the address of the animation) in the attributes
+#define VFD_ANIM_PERIOD_MSK   0x1F // Period of the element (1..31) in the attributes
+// Attributes of an element; an offset out of 0..3 or a period out of 1..31
+// doesn't compile (negative array size)
+#define VFD_ANIM_ATTRIBUTES(offset, period) \
+    (uint8_t)((((offset) << VFD_ANIM_BYTE_POS) | (period)) \
+              + 0 * sizeof(char[((offset) >= 0 && (offset) < VFD_ANIM_MAX_BYTES \
+                                 && (period) >= 1 && (period) <= VFD_ANIM_PERIOD_MSK) ? 1 : -1]))
+// Element: segments of the byte at the given offset (0..3), displayed 1 refresh out of period
+#define VFD_ANIM_ELEMENT(offset, period, segments) \
+    VFD_ANIM_ATTRIBUTES(offset, period), (uint8_t)(segments)
+#define VFD_ANIM_LAST_ELEMENT(offset, period, segments) \
+    (uint8_t)(VFD_ANIM_LAST | VFD_ANIM_ATTRIBUTES(offset, period)), (uint8_t)(segments)
+
+void VFD_playFrame(const uint8_t *animation, uint8_t address, uint8_t &frame_number, uint8_t &loop_number);
+void VFD_animationStart(const uint8_t *animation, uint8_t address);
+// Animations are played by the spinner service
+#define VFD_animationStop()          VFD_spinnerStop()
+#define VFD_animationRefresh()       VFD_spinnerRefresh()
+#define VFD_animationTick(NOW_US)    VFD_spinnerTick(NOW_US)
 void VFD_scrollText(const char *string, void (pfunc)()=nullptr);
+void VFD_scrollStart(const char *string);
+bool VFD_scrollTick(uint32_t now_ms);
+void VFD_scrollStop(void);
+
+#if ENABLE_GRAYSCALE == 1
+#define VFD_GRAY_MAX  ((1 << VFD_GRAY_BITS) - 1) // Full intensity
+void VFD_setSegmentLevel(uint8_t address, uint8_t segments, uint8_t level);
+void VFD_setGridLevel(uint8_t position, uint8_t level);
+void VFD_grayscaleRefresh(void);
+#endif
 
 #if ENABLE_ICON_BUFFER == 1
 extern char iconDisplayBuffer[PT6312_MAX_NR_GRIDS * PT6312_BYTES_PER_GRID];
@@ -180,6 +284,42 @@ uint32_t VFD_getKeys(void);
 uint8_t VFD_getKeyPressed(void);
 uint8_t VFD_getSwitches(void);
 
+// Key events (see VFD_pollKeyEvent())
+#define VFD_KEY_PRESS           0x01
+#define VFD_KEY_RELEASE         0x02
+#define VFD_KEY_LONG_PRESS      0x03
+#define VFD_KEY_REPEAT          0x04
+#define VFD_KEYS                4 // Keys in a sample of the key matrix
+
+typedef struct {
+    uint8_t type;   // VFD_KEY_PRESS, VFD_KEY_RELEASE, VFD_KEY_LONG_PRESS or VFD_KEY_REPEAT
+    uint8_t key;    // Button number (1..VFD_KEYS), like VFD_getKeyPressed()
+} vfd_key_event_t;
+
+void VFD_keyService(void);
+bool VFD_keyTick(uint32_t now_ms);
+bool VFD_pollKeyEvent(vfd_key_event_t *event);
+
+// Key matrix bitmap (see VFD_scanKeys()): 1 bit per key, layout of VFD_getKeys()
+#define VFD_KEY_BIT(sample, key)    (1UL << ((sample) * 4 + (key)))
+
+typedef struct {
+    uint32_t state;     // Keys pressed during the last scan
+    uint32_t pressed;   // Keys pressed since the previous scan
+    uint32_t released;  // Keys released since the previous scan
+} vfd_key_scan_t;
+
+void VFD_scanKeys(vfd_key_scan_t *scan);
+
+// All the keys of the chord are held (VFD_KEY_BIT() masks)
+inline bool VFD_chordHeld(const vfd_key_scan_t *scan, uint32_t chord){
+    return (scan->state & chord) == chord;
+}
+// The chord has just been completed: all its keys are held, 1 of them is new
+inline bool VFD_chordPressed(const vfd_key_scan_t *scan, uint32_t chord){
+    return VFD_chordHeld(scan, chord) && (scan->pressed & chord);
+}
+
 /**
  * Test functions
  */
@@ -190,13 +330,23 @@ void VFD_displayAllFontGlyphes(void);
 /**
  * Low level API
  */
+// Transport (see transport.cpp)
+void VFD_transportInit(void);
+void VFD_transportReadMode(void);
+void VFD_transportWriteMode(void);
 void VFD_command(uint8_t value, bool cmd=false);
 inline void VFD_CSSignal(){
-    _delay_us(1);
-    _digitalWrite(VFD_CS_PORT, VFD_CS_PIN, _HIGH);
-    _delay_us(1);
+    VFD_Driver::csSignal();
+}
+// No transmission in progress (CS/Strobe HIGH)
+inline bool VFD_transportIdle(){
+    return VFD_Transport::csIsHigh();
 }
 uint8_t VFD_readByte(void);
 void VFD_writeByte(uint8_t address, char data);
+void VFD_writeBytesAt(uint8_t address, uint16_t mask, uint16_t value);
+void VFD_writeBurst(uint8_t address, const uint8_t *data, uint8_t len);
+void VFD_waitIdle(void);
+void VFD_txService(void);
 
 #endif
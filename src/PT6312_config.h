@@ -0,0 +1,78 @@
+/* PT6312 is an Arduino library for the PT6312 family of Vacuum Fluorescent Display controllers.
+ * Copyright (C) 2022 Ysard - <ysard@users.noreply.github.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Compile-time configuration of a display: pins policy and geometry.
+ * All the members are constants or static inline functions, they fold into
+ * the code of the driver (see PT6312_display.h).
+ *
+ * The C API (VFD_* functions) uses the configuration of global.h:
+ *      VFD_Geometry<VFD_GRIDS> and VFD_Transport.
+ *
+ * Usage:
+ *      typedef VFD_Config<VFD_GpioPins<VFD_Pin<VFD_PortD, 2>,  // CS/STB
+ *                                      VFD_Pin<VFD_PortD, 3>,  // SCLK
+ *                                      VFD_Pin<VFD_PortD, 4>>, // DATA
+ *                         5> MyConfig;                         // Grids
+ */
+#ifndef PT6312_CONFIG_H
+#define PT6312_CONFIG_H
+
+/**
+ * Dirty bitmap of a framebuffer: the smallest unsigned type with 1 bit per byte
+ */
+template <uint8_t Bytes, bool Byte = (Bytes <= 8), bool Word = (Bytes <= 16)>
+struct VFD_DirtyMask            { typedef uint32_t type; };
+template <uint8_t Bytes, bool Word>
+struct VFD_DirtyMask<Bytes, true, Word>  { typedef uint8_t type; };
+template <uint8_t Bytes>
+struct VFD_DirtyMask<Bytes, false, true> { typedef uint16_t type; };
+
+/**
+ * Geometry of the display: the display mode of the controller is deduced
+ * from the number of grids (from 4 grids/16 segments to 11 grids/11 segments).
+ */
+template <uint8_t Grids>
+struct VFD_Geometry
+{
+    static_assert((Grids >= 4) && (Grids <= 11), "The PT6312 drives 4 to 11 grids");
+
+    static constexpr uint8_t grids    = Grids;
+    // 16 segments up to 6 grids, then 1 segment less per additional grid
+    static constexpr uint8_t segments = (Grids <= 6) ? 16 : 22 - Grids;
+    // Display mode setting command (PT6312_GR4_SEG16..PT6312_GR11_SEG11)
+    static constexpr uint8_t mode     = PT6312_MODE_SET_CMD | (Grids - 4);
+    // Size of the display memory in bytes
+    static constexpr uint8_t memory   = Grids * PT6312_BYTES_PER_GRID;
+
+    typedef typename VFD_DirtyMask<memory>::type Mask;
+};
+
+/**
+ * Configuration of a display driven by the bit-bang transport
+ * @param Pins Pins policy (VFD_GpioPins<>, VFD_AvrPins, VFD_HostPins; see transport.h).
+ * @param Grids Number of grids of the display.
+ */
+template <class Pins, uint8_t Grids>
+struct VFD_Config
+{
+    typedef Pins                              PinsPolicy;
+    typedef VFD_BitBangTransport<Pins>        Transport;
+    typedef PT6312Driver<Transport>           Driver;
+    typedef VFD_Geometry<Grids>               Geometry;
+};
+
+#endif // PT6312_CONFIG_H
@@ -0,0 +1,354 @@
+/* PT6312 is an Arduino library for the PT6312 family of Vacuum Fluorescent Display controllers.
+ * Copyright (C) 2022 Ysard - <ysard@users.noreply.github.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Display driven with a compile-time configuration (see PT6312_config.h).
+ * Each object has its own shadow framebuffer and grid cursor; displays of
+ * different configurations can coexist in the same program, independently
+ * of the C API (VFD_* functions) and of global.h.
+ *
+ * Characters are written as segments (2 bytes per grid); the glyphs of a font
+ * can be obtained with VFD_fontGlyph() (see display_variants/font_access.h).
+ * Text (writeString(), writeInt(), writeCharAt()) is rendered in the
+ * framebuffer of the object with the display variant of global.h
+ * (see VFD_renderString()).
+ *
+ * Usage:
+ *      PT6312Display<MyConfig> display;
+ *      display.initialize();
+ *      display.setGrid(1, VFD_fontGlyph('A'));
+ *      display.flush();
+ *
+ * Several displays on a shared bus: see VFD_initializeAll() & VFD_flushAll().
+ */
+#ifndef PT6312_DISPLAY_H
+#define PT6312_DISPLAY_H
+
+#include "PT6312.h"
+
+template <class Config>
+class PT6312Display
+{
+public:
+    typedef typename Config::Driver   Driver;
+    typedef typename Config::Geometry Geometry;
+    typedef typename Geometry::Mask   Mask;
+
+    // Grid cursor (starting from 1)
+    uint8_t grid_cursor;
+    // Shadow framebuffer: RAM mirror of the display memory of the controller
+    uint8_t buffer[Geometry::memory];
+    Mask    dirty_mask;
+
+    /**
+     * @brief Configure the controller and the pins of the MCU.
+     * @see VFD_initialize()
+     */
+    void initialize()
+    {
+        Driver::init();
+
+        // Waiting for the VFD driver to startup
+        _delay_ms(500);
+
+        configure();
+    }
+
+    /**
+     * @brief Configure the controller; the pins must be initialized and the
+     *      controller started (see VFD_initializeAll()).
+     */
+    void configure()
+    {
+        // Set display mode (number of digits & segments)
+        Driver::command(Geometry::mode, true);
+
+        resetDisplay();
+
+        for (uint8_t i = 0; i < Geometry::memory; i++)
+            buffer[i] = 0;
+        invalidate();
+        grid_cursor = 1;
+    }
+
+    /**
+     * @brief Turn on the display and restore the default write mode.
+     * @see VFD_resetDisplay()
+     */
+    void resetDisplay()
+    {
+        Driver::forgetState();
+        setBrightness(PT6312_BRT_DEF);
+    }
+
+    /**
+     * @brief Set display brightness
+     * @param brightness Valid range 0..7
+     * @see VFD_setBrightness()
+     */
+    void setBrightness(uint8_t brightness)
+    {
+        Driver::displayControl(PT6312_DSP_CTRL_CMD | PT6312_DSP_ON | (brightness & PT6312_BRT_MSK));
+    }
+
+    void displayOff()
+    {
+        Driver::command(PT6312_DSP_CTRL_CMD | PT6312_DSP_OFF | PT6312_BRT0, true);
+    }
+
+    /**
+     * @brief Write a byte in the shadow framebuffer.
+     * @see VFD_setBufferByte()
+     */
+    void setBufferByte(uint8_t address, uint8_t data)
+    {
+        if (address >= Geometry::memory)
+            return;
+
+        if (buffer[address] != data) {
+            buffer[address] = data;
+            dirty_mask |= (Mask)1 << address;
+        }
+    }
+
+    /**
+     * @brief Write the segments of a grid in the shadow framebuffer.
+     * @param position Grid number (1..Geometry::grids).
+     * @param segments MSB: segments 16..9, LSB: segments 8..1 (i.e. VFD_fontGlyph()).
+     */
+    void setGrid(uint8_t position, uint16_t segments)
+    {
+        uint8_t address = (position * PT6312_BYTES_PER_GRID) - PT6312_BYTES_PER_GRID;
+        setBufferByte(address, segments);
+        setBufferByte(address + 1, segments >> 8);
+    }
+
+    /**
+     * @brief Write segments at the grid cursor; the cursor is incremented.
+     * @see setGrid()
+     */
+    void write(uint16_t segments)
+    {
+        setGrid(grid_cursor, segments);
+        setGridCursor(grid_cursor + 1);
+    }
+
+    /**
+     * @brief Write a string at the grid cursor and send the modified bytes.
+     *      The string is rendered by the display variant of global.h; the grid
+     *      cursor is updated like the one of the C API.
+     * @see VFD_writeString(), VFD_renderString()
+     */
+    void writeString(const char *string, bool colon_symbol)
+    {
+        uint8_t bytes[VFD_RENDER_MAX_BYTES];
+        uint8_t address = (grid_cursor * PT6312_BYTES_PER_GRID) - PT6312_BYTES_PER_GRID;
+        uint8_t count   = VFD_renderString(bytes, string, colon_symbol, grid_cursor);
+
+        for (uint8_t i = 0; i < count; i++)
+            setBufferByte(address + i, bytes[i]);
+        flush();
+    }
+
+    /**
+     * @brief Write a number at the grid cursor.
+     * @see VFD_writeInt(), VFD_formatInt()
+     */
+    void writeInt(int32_t number, int8_t digits_number, bool colon_symbol)
+    {
+        char string[VFD_DISPLAYABLE_DIGITS + 1];
+
+        VFD_formatInt(string, number, digits_number, grid_cursor);
+        writeString(string, colon_symbol);
+    }
+
+    /**
+     * @brief Write 1 character without rewriting the line; only the modified
+     *      bytes are sent. The position is counted from the left of the
+     *      display, whatever the grid cursor.
+     * @see VFD_writeCharAt(), VFD_renderCharAt()
+     */
+    void writeCharAt(uint8_t position, char character)
+    {
+        uint16_t mask = 0, value = 0;
+        uint8_t  address = VFD_renderCharAt(position, character, mask, value);
+
+        writeBytesAt(address, mask, value);
+    }
+
+    /**
+     * @brief Modify some segments of 1 or 2 consecutive bytes and send them.
+     * @see VFD_writeBytesAt()
+     */
+    void writeBytesAt(uint8_t address, uint16_t mask, uint16_t value)
+    {
+        if ((address >= Geometry::memory) || (mask == 0))
+            return;
+
+        // Range of the bytes with segments to modify
+        uint8_t first = 0, len = 0;
+
+        for (uint8_t i = 0; (i < 2) && (address < Geometry::memory); i++, address++) {
+            if ((uint8_t)mask) {
+                setBufferByte(address, (buffer[address] & ~mask) | (value & mask));
+                if (len == 0)
+                    first = address;
+                len = address - first + 1;
+            }
+            mask  >>= 8;
+            value >>= 8;
+        }
+        if (len)
+            flushRange(first, len);
+    }
+
+    /**
+     * @brief Set the cursor on the given grid position.
+     * @see VFD_setGridCursor()
+     */
+    void setGridCursor(uint8_t position)
+    {
+        if (position > Geometry::grids) {
+            position = (position == Geometry::grids + 1) ? 1 : Geometry::grids;
+        } else if (position == 0) {
+            position = Geometry::grids;
+        }
+        grid_cursor = position;
+    }
+
+    /**
+     * @brief Send the dirty bytes of the shadow framebuffer to the controller.
+     * @see VFD_flush()
+     */
+    void flush()
+    {
+        Mask pending = dirty_mask;
+
+        dirty_mask = 0;
+        Driver::flush(buffer, pending);
+    }
+
+    /**
+     * @brief Send the dirty bytes of a range of the shadow framebuffer;
+     *      the other dirty bytes stay pending.
+     * @see VFD_flushRange()
+     */
+    void flushRange(uint8_t address, uint8_t len)
+    {
+        if ((address >= Geometry::memory) || (len == 0))
+            return;
+        if (len > Geometry::memory - address)
+            len = Geometry::memory - address;
+
+        Mask range   = ((Mask)~(Mask)0 >> (sizeof(Mask) * 8 - len)) << address;
+        Mask pending = dirty_mask & range;
+
+        dirty_mask &= ~range;
+        Driver::flush(buffer, pending);
+    }
+
+    /**
+     * @brief Flag the whole shadow framebuffer as dirty.
+     * @see VFD_invalidate()
+     */
+    void invalidate()
+    {
+        dirty_mask = (Mask)~(Mask)0 >> (sizeof(Mask) * 8 - Geometry::memory);
+    }
+
+    /**
+     * @brief Turn off all segments.
+     * @see VFD_clear()
+     */
+    void clear()
+    {
+        for (uint8_t i = 0; i < Geometry::memory; i++)
+            setBufferByte(i, 0);
+        flush();
+        // Same convention as VFD_clear()
+        grid_cursor = Geometry::grids;
+    }
+
+    uint32_t getKeys()            { return Driver::readKeys(); }
+
+    /**
+     * @brief Read the whole key matrix in 1 transmission and compute the edges.
+     * @see VFD_scanKeys()
+     */
+    void scanKeys(vfd_key_scan_t *scan)
+    {
+        uint32_t state = Driver::readKeys();
+
+        scan->pressed  = state & ~scan->state;
+        scan->released = scan->state & ~state;
+        scan->state    = state;
+    }
+
+    uint8_t  getSwitches()        { return Driver::readSwitches(); }
+    void     setLEDs(uint8_t leds) { Driver::writeLEDs(leds); }
+};
+
+
+/**
+ * Controllers sharing the SCLK & DATA lines, 1 STB line per controller
+ * (i.e. configurations that only differ by the Cs pin of VFD_GpioPins).
+ * Only the controller whose STB line is LOW listens to the bus; the keys are
+ * read with getKeys() on the display that owns the keypad.
+ *
+ * Usage:
+ *      typedef VFD_Config<VFD_GpioPins<VFD_Pin<VFD_PortB, 2>, Sclk, Data>, 7> Left;
+ *      typedef VFD_Config<VFD_GpioPins<VFD_Pin<VFD_PortB, 1>, Sclk, Data>, 7> Right;
+ *      PT6312Display<Left> left;
+ *      PT6312Display<Right> right;
+ *      VFD_initializeAll(left, right);
+ *      ...
+ *      VFD_flushAll(left, right);
+ */
+
+/**
+ * @brief Initialize several displays: the pins are configured first, then the
+ *      controllers are started together (1 startup delay for all).
+ * @see PT6312Display::initialize()
+ */
+template <class... Displays>
+void VFD_initializeAll(Displays&... displays)
+{
+    int pins[] = {0, (Displays::Driver::init(), 0)...};
+    (void)pins;
+
+    // Waiting for the VFD drivers to startup
+    _delay_ms(500);
+
+    int controllers[] = {0, (displays.configure(), 0)...};
+    (void)controllers;
+}
+
+/**
+ * @brief Send the dirty bytes of several displays back to back.
+ *      Nothing is shared between the controllers: each one only listens
+ *      during its own strobe windows, so each display sends its own commands
+ *      (display control and write mode if needed, address) exactly as with
+ *      a call to flush() per display.
+ * @see PT6312Display::flush()
+ */
+template <class... Displays>
+void VFD_flushAll(Displays&... displays)
+{
+    int flushed[] = {0, (displays.flush(), 0)...};
+    (void)flushed;
+}
+
+#endif // PT6312_DISPLAY_H
@@ -0,0 +1,320 @@
+/* PT6312 is an Arduino library for the PT6312 family of Vacuum Fluorescent Display controllers.
+ * Copyright (C) 2022 Ysard - <ysard@users.noreply.github.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef PT6312_DRIVER_H
+#define PT6312_DRIVER_H
+
+// Value of the state cache when the setting of the controller is not known
+#define PT6312_STATE_UNKNOWN     0xFF
+// Data setting command of the default mode: write to memory, auto increment the address
+#define PT6312_DATA_WRITE_MODE   (PT6312_DATA_SET_CMD | PT6312_MODE_NORM | PT6312_ADDR_INC | PT6312_DATA_WR)
+
+/**
+ * Bus protocol of the controller (transmissions framed by the CS/Strobe line),
+ * independent of the way the bits are moved.
+ *
+ * The Transport policy is a class with static members:
+ *      init(): configure the pins/peripheral; CS and SCLK HIGH when idle,
+ *      csLow(), csHigh(), csIsHigh(): CS/Strobe line,
+ *      strobeDelay(): setup/hold time around the edges of the CS/Strobe line,
+ *      write(byte): shift a byte out, LSB first,
+ *      read(): shift a byte in, LSB first,
+ *      readMode(), writeMode(): release/take back the DATA line.
+ * Everything is static inline: the C API (VFD_command(), etc.) is a thin wrapper
+ * around PT6312Driver<VFD_Transport> (see transport.h).
+ *
+ * The last data setting and display control commands are cached (1 cache per
+ * Transport, i.e. per controller): a command that doesn't change the setting
+ * of the controller is not sent. The write mode is restored lazily, before the
+ * next write to the memory.
+ * The commands sent with command() are tracked, a raw address setting command
+ * is preceded by the write mode if needed.
+ *
+ * Display wake up: the display is turned off at power on and by a mode setting
+ * command, and a display control command that turns it on takes effect with the
+ * data setting command that follows it (a brightness change of a lit display
+ * is a single command). The display control is therefore resent (with the
+ * write mode) before the next write to the memory after a mode setting or a
+ * reset of the cache, and every VFD_RESYNC_INTERVAL flushes if it is not 0.
+ */
+template <class Transport>
+struct PT6312Driver
+{
+    // Last data setting command sent to the controller (PT6312_STATE_UNKNOWN: must be sent)
+    static uint8_t  data_setting;
+    // Display control wanted by the program; resent before the next write if display_synced is false
+    static uint8_t  display_control;
+    static bool     display_synced;
+    // Flushes since the last display control
+    static uint16_t resync_frames;
+
+    static inline void init()
+    {
+        Transport::init();
+        forgetState();
+    }
+
+    /**
+     * @brief Forget the settings of the controller: the next commands are sent
+     *      even if they are identical to the previous ones.
+     */
+    static inline void forgetState()
+    {
+        data_setting   = PT6312_STATE_UNKNOWN;
+        display_synced = false;
+    }
+
+    /**
+     * @brief Signal the driver that the data transmission is over.
+     * @see VFD_CSSignal()
+     */
+    static inline void csSignal()
+    {
+        Transport::strobeDelay();
+        Transport::csHigh();
+        Transport::strobeDelay();
+    }
+
+    /**
+     * @brief Send a byte; the transmission is started if needed.
+     * @see VFD_command()
+     */
+    static inline void command(uint8_t value, bool cmd)
+    {
+        if (Transport::csIsHigh()) {
+            // Start of transmission: the 1st byte is a command
+            track(value);
+
+            Transport::csLow();
+            Transport::strobeDelay(); // NOTE: not in datasheet
+        }
+
+        Transport::write(value);
+
+        if (cmd) {
+            csSignal();
+        }
+    }
+
+    /**
+     * @brief Write consecutive bytes in the controller memory in 1 transmission.
+     * @see VFD_writeBurst()
+     */
+    static inline void writeBurst(uint8_t address, const uint8_t *data, uint8_t len)
+    {
+        // Close any pending transmission: the address must be the first byte of a window
+        if (!Transport::csIsHigh()) {
+            csSignal();
+        }
+
+        syncDisplay();
+        restoreWriteMode();
+        command(PT6312_ADDR_SET_CMD | (address & PT6312_ADDR_MSK), false);
+        while (len--) {
+            Transport::write(*data++);
+        }
+        csSignal();
+    }
+
+    /**
+     * @brief Send the dirty runs of a framebuffer, 1 transmission per run.
+     *      A single clean byte between 2 dirty runs is sent again.
+     * @param buffer Framebuffer (mirror of the display memory).
+     * @param pending Dirty bitmap: bit n set if buffer[n] must be sent.
+     * @see VFD_flush()
+     */
+    template <typename Mask>
+    static inline void flush(const uint8_t *buffer, Mask pending)
+    {
+        uint8_t address = 0, start;
+
+        #if VFD_RESYNC_INTERVAL > 0
+        if (pending && (++resync_frames >= VFD_RESYNC_INTERVAL)) {
+            // Periodic resend of the display control
+            display_synced = false;
+        }
+        #endif
+
+        while (pending) {
+            // Skip clean bytes
+            while ((pending & 1) == 0) {
+                pending >>= 1;
+                address++;
+            }
+
+            // Find the end of the run; continue while the next byte or the one after it is dirty
+            start = address;
+            do {
+                pending >>= 1;
+                address++;
+            } while (pending & 0x03);
+
+            writeBurst(start, &buffer[start], address - start);
+        }
+    }
+
+    /**
+     * @brief Read the key matrix (PT6312_KEY_MEM bytes).
+     * @see VFD_getKeys()
+     */
+    static inline uint32_t readKeys()
+    {
+        // Enable Key Read mode
+        // Data set cmd, normal mode, auto incr, read data
+        command(PT6312_DATA_SET_CMD | PT6312_MODE_NORM | PT6312_ADDR_INC | PT6312_KEY_RD, false);
+
+        readMode();
+
+        // Read the key matrix of size PT6312_KEY_MEM bytes
+        // 3 bytes = 3 readings
+        uint32_t raw_keys = PT6312_KEY_MSK & readByte();
+        raw_keys = (raw_keys << 8) + (PT6312_KEY_MSK & readByte());
+        raw_keys = (raw_keys << 8) + (PT6312_KEY_MSK & readByte());
+
+        writeMode();
+        csSignal();
+
+        return raw_keys;
+    }
+
+    /**
+     * @brief Read the 4 generic switches.
+     * @see VFD_getSwitches()
+     */
+    static inline uint8_t readSwitches()
+    {
+        // Enable Switch Read mode
+        // Data set cmd, normal mode, auto incr, read data
+        command(PT6312_DATA_SET_CMD | PT6312_MODE_NORM | PT6312_ADDR_INC | PT6312_SW_RD, false);
+
+        readMode();
+
+        uint8_t raw_switches = PT6312_SW_MSK & readByte();
+
+        writeMode();
+        csSignal();
+
+        return raw_switches;
+    }
+
+    /**
+     * @brief Set the LED port (bit set: LED on).
+     * @see VFD_setLEDs()
+     */
+    static inline void writeLEDs(uint8_t leds)
+    {
+        // Enable LED Read mode
+        // Data set cmd, normal mode, auto incr, write data to LED port
+        command(PT6312_DATA_SET_CMD | PT6312_MODE_NORM | PT6312_ADDR_INC | PT6312_LED_WR, false);
+
+        // Invert the bits:
+        // 0: LED lights
+        // 1: LED turns off
+        command(~leds & PT6312_LED_MSK, true);
+    }
+
+    /**
+     * @brief Restore Data Write mode (write to memory, auto increment the address);
+     *      nothing is sent if the controller is already in this mode.
+     */
+    static inline void restoreWriteMode()
+    {
+        if (data_setting != PT6312_DATA_WRITE_MODE)
+            command(PT6312_DATA_WRITE_MODE, true);
+    }
+
+    /**
+     * @brief Send a display control command (on/off, brightness) if it changes the display.
+     *      If the display is turned on, it is followed by the write mode, required
+     *      to wake up the display; a brightness change is 1 command only.
+     * @see VFD_setBrightness()
+     */
+    static inline void displayControl(uint8_t value)
+    {
+        if ((value == display_control) && display_synced)
+            return;
+
+        command(value, true);
+        restoreWriteMode();
+    }
+
+    /**
+     * @brief Resend the display control if the display may be off (see display_synced).
+     *      The write mode must be restored after it (see track()).
+     */
+    static inline void syncDisplay()
+    {
+        if (!display_synced)
+            command(display_control, true);
+    }
+
+    /**
+     * @brief Update the state cache with the command that starts a transmission.
+     */
+    static inline void track(uint8_t value)
+    {
+        switch (value & PT6312_CMD_TYPE_MSK) {
+        case PT6312_MODE_SET_CMD:
+            // The display is turned off by the controller
+            forgetState();
+            break;
+        case PT6312_DATA_SET_CMD:
+            data_setting = value;
+            break;
+        case PT6312_DSP_CTRL_CMD:
+            if (!display_synced || !(display_control & PT6312_DSP_ON)) {
+                // The display wakes up with the next data setting command
+                data_setting = PT6312_STATE_UNKNOWN;
+            }
+            display_control = value;
+            display_synced  = true;
+            resync_frames   = 0;
+            break;
+        default:
+            // Address setting: a raw write (VFD_command()) may follow a mode setting or a read
+            syncDisplay();
+            if ((data_setting & PT6312_DATA_RD_MSK) != PT6312_DATA_WR) {
+                command(PT6312_DATA_WRITE_MODE, true);
+            }
+        }
+    }
+
+    static inline uint8_t readByte()
+    {
+        return Transport::read();
+    }
+
+    static inline void readMode()
+    {
+        Transport::readMode();
+    }
+
+    static inline void writeMode()
+    {
+        Transport::writeMode();
+    }
+};
+
+template <class Transport>
+uint8_t PT6312Driver<Transport>::data_setting = PT6312_STATE_UNKNOWN;
+template <class Transport>
+uint8_t PT6312Driver<Transport>::display_control = PT6312_DSP_CTRL_CMD | PT6312_DSP_ON | PT6312_BRT_DEF;
+template <class Transport>
+bool PT6312Driver<Transport>::display_synced = false;
+template <class Transport>
+uint16_t PT6312Driver<Transport>::resync_frames = 0;
+
+#endif // PT6312_DRIVER_H
@@ -0,0 +1,55 @@
+/* PT6312 is an Arduino library for the PT6312 family of Vacuum Fluorescent Display controllers.
+ * Copyright (C) 2022 Ysard - <ysard@users.noreply.github.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Accessors of the font tables of the display variants.
+ * FONT and ICONS_FONT are stored in flash (PROGMEM): they MUST NOT be read directly.
+ * This file is included at the end of the font files.
+ */
+#ifndef FONT_ACCESS_H
+#define FONT_ACCESS_H
+
+/**
+ * @brief Get the segments of a character (2 bytes of a grid).
+ * @param character ASCII code, starting from 0x20 (space character).
+ * @return MSB: FONT[][0], LSB: FONT[][1].
+ */
+inline uint16_t VFD_fontGlyph(char character)
+{
+    // 1 word read: FONT[][0] is the low byte in memory (little endian)
+    uint16_t glyph = pgm_read_word(&FONT[character - 0x20][0]);
+    return (glyph << 8) | (glyph >> 8);
+}
+
+/**
+ * @brief Get the LSB part of the segments of a character (FONT[][1]).
+ * @param character ASCII code, starting from 0x20 (space character).
+ */
+inline uint8_t VFD_fontLSB(char character)
+{
+    return pgm_read_byte(&FONT[character - 0x20][1]);
+}
+
+/**
+ * @brief Get the location of an icon (grid & segment numbers).
+ * @param icon_font_index Index of the icon in the ICONS_FONT array.
+ */
+inline uint8_t VFD_iconLocation(uint8_t icon_font_index)
+{
+    return pgm_read_byte(&ICONS_FONT[icon_font_index]);
+}
+
+#endif // FONT_ACCESS_H
@@ -0,0 +1,67 @@
+/* PT6312 is an Arduino library for the PT6312 family of Vacuum Fluorescent Display controllers.
+ * Copyright (C) 2022 Ysard - <ysard@users.noreply.github.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Compile-time builder of the glyphs of the FONT tables.
+ *
+ * A font file names the segments of its display with the number of the segment
+ * in a grid (starting from 1, i.e. the bit number + 1):
+ *      enum { SEG_TOP = 7, SEG_MIDDLE = 4, ... };
+ * and describes each glyph with the list of its segments:
+ *      VFD_GLYPH(SEG_TOP, SEG_MIDDLE), // =
+ * The macro expands to the 2 bytes {MSB, LSB} of a FONT entry; everything is
+ * computed by the compiler, the table stays in flash like a hand-written one.
+ *
+ * Compilation fails if a segment number is out of range (1..16)
+ * or if a glyph uses the same segment twice.
+ * VFD_CHECK_SEGMENTS() with all the segments of a display catches 2 names
+ * sharing the same segment number.
+ */
+#ifndef FONT_BUILDER_H
+#define FONT_BUILDER_H
+
+template <uint8_t... Segments>
+struct VFD_Glyph;
+
+template <>
+struct VFD_Glyph<>
+{
+    static constexpr uint16_t value = 0;
+    static constexpr uint8_t  msb   = 0;
+    static constexpr uint8_t  lsb   = 0;
+};
+
+template <uint8_t Segment, uint8_t... Others>
+struct VFD_Glyph<Segment, Others...>
+{
+    static_assert((Segment >= 1) && (Segment <= 8 * PT6312_BYTES_PER_GRID),
+                  "Segment number out of range (1..16)");
+    static_assert((VFD_Glyph<Others...>::value & (1u << (Segment - 1))) == 0,
+                  "Segment used twice in the same glyph");
+
+    static constexpr uint16_t value = (1u << (Segment - 1)) | VFD_Glyph<Others...>::value;
+    static constexpr uint8_t  msb   = value >> 8;
+    static constexpr uint8_t  lsb   = value & 0xFF;
+};
+
+// Entry {MSB, LSB} of a FONT table
+#define VFD_GLYPH(...)  {VFD_Glyph<__VA_ARGS__>::msb, VFD_Glyph<__VA_ARGS__>::lsb}
+
+// All the segments of a display must have different numbers
+#define VFD_CHECK_SEGMENTS(...) \
+    static_assert(VFD_Glyph<__VA_ARGS__>::value != 0, "No segment")
+
+#endif // FONT_BUILDER_H
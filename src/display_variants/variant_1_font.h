@@ -18,6 +18,7 @@
 #define FONT_H
 
 #include "PT6312.h"
+#include "display_variants/font_builder.h"
 // Segment numbering for ET16312n VFD driver
 //         8
 //     ---------
@@ -114,74 +115,95 @@ const uint8_t FONT[65][2] = {
 };
 */
 
+// Segment numbers (starting from 1) of the 2nd drawing.
+// The colon symbol is lit with the character before it; only the LSB of a grid is used.
+enum {
+    SEG_D     = 1,
+    SEG_E     = 2,
+    SEG_C     = 3,
+    SEG_G     = 4,
+    SEG_F     = 5,
+    SEG_B     = 6,
+    SEG_A     = 7,
+    SEG_COLON = 8,
+};
+VFD_CHECK_SEGMENTS(SEG_A, SEG_B, SEG_C, SEG_D, SEG_E, SEG_F, SEG_G, SEG_COLON);
+static_assert(VFD_Glyph<SEG_A, SEG_B, SEG_C, SEG_D, SEG_E, SEG_F, SEG_G, SEG_COLON>::msb == 0,
+              "A character of this display must fit in the LSB of a grid");
+
 //OBS: GRID 5 COMEÇA NO BIT 3!!
-const uint8_t FONT[65][2] = {
-    {0b00000000, 0b00000000}, // space 0x20
-    {0b00000000, 0b00000000}, // ! N/A
-    {0b00000000, 0b00000000}, // " N/A
-    {0b00000000, 0b00000000}, // # N/A
-    {0b00000000, 0b00000000}, // $ N/A
-    {0b00000000, 0b00000000}, // % N/A
-    {0b00000000, 0b00000000}, // & N/A
-    {0b00000000, 0b00000000}, // ' N/A
-    {0b00000000, 0b00000000}, // ( (bits 8, 6, 3, 2)
-    {0b00000000, 0b00000000}, // ) (bits 8, 7, 4, 2)
-    {0b00000000, 0b00000000}, // * N/A
-    {0b00000000, 0b00000000}, // + N/A
-    {0b00000000, 0b00000000}, // , N/A
-    {0b00000000, 0b00001000}, // - (bit 4)
-    {0b00000000, 0b00000000}, // . N/A
-    {0b00000000, 0b00000000}, // / N/A
-    {0b00000000, 0b01110111}, // 0 (bits 8, 7, 6, 4, 3, 2)
-    {0b00000000, 0b00100100}, // 1 (bits 7, 4)
-    {0b00000000, 0b01101011}, // 2 (bits 8, 7, 5, 3, 2)
-    {0b00000000, 0b01101101}, // 3 (bits 7, 6, 4, 3, 1)
-    {0b00000000, 0b00111100}, // 4 (bits 7, 6, 5, 4)
-    {0b00000000, 0b01011101}, // 5 (bits 8, 6, 5, 4, 2)
-    {0b00000000, 0b01011111}, // 6 (bits 8, 6, 5, 4, 3, 2)
-    {0b00000000, 0b01100100}, // 7 (bits 8, 7, 4)
-    {0b00000000, 0b01111111}, // 8 (bits 8, 7, 6, 5, 4, 3, 2)
-    {0b00000000, 0b01111101}, // 9 (bits 8, 7, 6, 5, 4, 2)
-    {0b00000000, 0b10000000}, // : (bit 1) available before 5-th digit only
-    {0b00000000, 0b00000000}, // ; N/A
-    {0b00000000, 0b00000000}, // < N/A
-    {0b00000000, 0b00001001}, // = (bits 5, 2)
-    {0b00000000, 0b00000000}, // > N/A
-    {0b00000000, 0b00000000}, // ? N/A
-    {0b00000000, 0b00000000}, // @ N/A
-    {0b00000000, 0b01111110}, // A (bits 8, 7, 6, 5, 4, 3)
-    {0b00000000, 0b00011111}, // B (bits 8, 7, 6, 5, 4, 3, 2)
-    {0b00000000, 0b01010011}, // C (bits 8, 6, 3, 2)
-    {0b00000000, 0b00101111}, // d (bits 8, 7, 6, 4, 3, 2)
-    {0b00000000, 0b01011011}, // E (bits 8, 6, 5, 3, 2)
-    {0b00000000, 0b01011010}, // F (bits 8, 6, 5, 3)
-    {0b00000000, 0b01011111}, // G (bits 8, 6, 5, 4, 3, 2)
-    {0b00000000, 0b00011110}, // h (bits 5, 4, 3, 2)
-    {0b00000000, 0b00100100}, // I (bits 6, 3)
-    {0b00000000, 0b00100101}, // J (bits 6, 3, 1)
-    {0b00000000, 0b00000000}, // K N/A
-    {0b00000000, 0b00010011}, // L (bits 6, 3, 2)
-    {0b00000000, 0b00001110}, // m (bits 4, 3, 2)
-    {0b00000000, 0b01110110}, // N (bits 8, 7, 6, 4, 3)
-    {0b00000000, 0b01110111}, // O (bits 5, 4, 3, 2)
-    {0b00000000, 0b01111010}, // P (bits 8, 7, 6, 3)
-    {0b00000000, 0b01111100}, // Q (bits 5, 4, 3, 2)
-    {0b00000000, 0b01101110}, // R (bits 8, 7, 5, 3, 2)
-    {0b00000000, 0b01011101}, // S (bits 8, 6, 5, 4, 2)
-    {0b00000000, 0b00011011}, // T (bits 8, 7, 4)
-    {0b00000000, 0b00000111}, // U (bits 7, 6, 4, 3, 2)
-    {0b00000000, 0b00110111}, // V (bits 7, 6, 4, 3, 2)
-    {0b00000000, 0b00111000}, // W (bits 6, 5, 4,)
-    {0b00000000, 0b00111110}, // X (bits 8, 7, 6, 5, 4, 3, 2)
-    {0b00000000, 0b00111101}, // Y (bits 7, 6, 5, 4)
-    {0b00000000, 0b01101011}, // Z (bits 8, 7, 5, 3, 2)
-    {0b00000000, 0b01010011}, // [ (bits 7, 5, 2, 1)
-    {0b00000000, 0b00000000}, // \ N/A
-    {0b00000000, 0b01100101}, // ] (bits 7, 6, 3, 1)
-    {0b00000000, 0b00000000}, // ^ N/A
-    {0b00000000, 0b00000001}, // _ (bit 1)
+const uint8_t FONT[65][2] PROGMEM = {
+    VFD_GLYPH(), // space 0x20
+    VFD_GLYPH(), // ! N/A
+    VFD_GLYPH(), // " N/A
+    VFD_GLYPH(), // # N/A
+    VFD_GLYPH(), // $ N/A
+    VFD_GLYPH(), // % N/A
+    VFD_GLYPH(), // & N/A
+    VFD_GLYPH(), // ' N/A
+    VFD_GLYPH(), // (
+    VFD_GLYPH(), // )
+    VFD_GLYPH(), // * N/A
+    VFD_GLYPH(), // + N/A
+    VFD_GLYPH(), // , N/A
+    VFD_GLYPH(SEG_G), // -
+    VFD_GLYPH(), // . N/A
+    VFD_GLYPH(), // / N/A
+    VFD_GLYPH(SEG_A, SEG_B, SEG_C, SEG_D, SEG_E, SEG_F), // 0
+    VFD_GLYPH(SEG_B, SEG_C), // 1
+    VFD_GLYPH(SEG_A, SEG_B, SEG_D, SEG_E, SEG_G), // 2
+    VFD_GLYPH(SEG_A, SEG_B, SEG_C, SEG_D, SEG_G), // 3
+    VFD_GLYPH(SEG_B, SEG_C, SEG_F, SEG_G), // 4
+    VFD_GLYPH(SEG_A, SEG_C, SEG_D, SEG_F, SEG_G), // 5
+    VFD_GLYPH(SEG_A, SEG_C, SEG_D, SEG_E, SEG_F, SEG_G), // 6
+    VFD_GLYPH(SEG_A, SEG_B, SEG_C), // 7
+    VFD_GLYPH(SEG_A, SEG_B, SEG_C, SEG_D, SEG_E, SEG_F, SEG_G), // 8
+    VFD_GLYPH(SEG_A, SEG_B, SEG_C, SEG_D, SEG_F, SEG_G), // 9
+    VFD_GLYPH(SEG_COLON), // : available before 5-th digit only
+    VFD_GLYPH(), // ; N/A
+    VFD_GLYPH(), // < N/A
+    VFD_GLYPH(SEG_D, SEG_G), // =
+    VFD_GLYPH(), // > N/A
+    VFD_GLYPH(), // ? N/A
+    VFD_GLYPH(), // @ N/A
+    VFD_GLYPH(SEG_A, SEG_B, SEG_C, SEG_E, SEG_F, SEG_G), // A
+    VFD_GLYPH(SEG_C, SEG_D, SEG_E, SEG_F, SEG_G), // B
+    VFD_GLYPH(SEG_A, SEG_D, SEG_E, SEG_F), // C
+    VFD_GLYPH(SEG_B, SEG_C, SEG_D, SEG_E, SEG_G), // d
+    VFD_GLYPH(SEG_A, SEG_D, SEG_E, SEG_F, SEG_G), // E
+    VFD_GLYPH(SEG_A, SEG_E, SEG_F, SEG_G), // F
+    VFD_GLYPH(SEG_A, SEG_C, SEG_D, SEG_E, SEG_F, SEG_G), // G
+    VFD_GLYPH(SEG_C, SEG_E, SEG_F, SEG_G), // h
+    VFD_GLYPH(SEG_B, SEG_C), // I
+    VFD_GLYPH(SEG_B, SEG_C, SEG_D), // J
+    VFD_GLYPH(), // K N/A
+    VFD_GLYPH(SEG_D, SEG_E, SEG_F), // L
+    VFD_GLYPH(SEG_C, SEG_E, SEG_G), // m
+    VFD_GLYPH(SEG_A, SEG_B, SEG_C, SEG_E, SEG_F), // N
+    VFD_GLYPH(SEG_A, SEG_B, SEG_C, SEG_D, SEG_E, SEG_F), // O
+    VFD_GLYPH(SEG_A, SEG_B, SEG_E, SEG_F, SEG_G), // P
+    VFD_GLYPH(SEG_A, SEG_B, SEG_C, SEG_F, SEG_G), // Q
+    VFD_GLYPH(SEG_A, SEG_B, SEG_C, SEG_E, SEG_G), // R
+    VFD_GLYPH(SEG_A, SEG_C, SEG_D, SEG_F, SEG_G), // S
+    VFD_GLYPH(SEG_D, SEG_E, SEG_F, SEG_G), // T
+    VFD_GLYPH(SEG_C, SEG_D, SEG_E), // U
+    VFD_GLYPH(SEG_B, SEG_C, SEG_D, SEG_E, SEG_F), // V
+    VFD_GLYPH(SEG_B, SEG_F, SEG_G), // W
+    VFD_GLYPH(SEG_B, SEG_C, SEG_E, SEG_F, SEG_G), // X
+    VFD_GLYPH(SEG_B, SEG_C, SEG_D, SEG_F, SEG_G), // Y
+    VFD_GLYPH(SEG_A, SEG_B, SEG_D, SEG_E, SEG_G), // Z
+    VFD_GLYPH(SEG_A, SEG_D, SEG_E, SEG_F), // [
+    VFD_GLYPH(), // \ N/A
+    VFD_GLYPH(SEG_A, SEG_B, SEG_C, SEG_D), // ]
+    VFD_GLYPH(), // ^ N/A
+    VFD_GLYPH(SEG_D), // _
 };
 
+// Decimal point map (see VFD_writeFixed()): bit n set if the character at the
+// address n of the display memory has a colon/dot symbol (SEG_COLON) after it.
+// The symbol is available before the 5-th digit only.
+#define VFD_DP_MAP  (1UL << 3)
+
 // Shortcuts refering to the indexes in the table ICONS_FONT
 #define ICON_PBC          0
 #define ICON_DVD          1
@@ -202,7 +224,7 @@ const uint8_t FONT[65][2] = {
 // 2 sections of 4 bits in 1 byte:
 // LSB: grid number starting from 0
 // MSB: segment number starting from 0
-const uint8_t ICONS_FONT[] = {
+const uint8_t ICONS_FONT[] PROGMEM = {
     0b10000000, // Index 0:  Grid 0; 9;  PBC
     0b10010000, // Index 1:  Grid 0; 10; DVD
     0b00000001, // Index 2:  Grid 1; 1;  Play
@@ -220,4 +242,6 @@ const uint8_t ICONS_FONT[] = {
     0b10000011, // Index 14: Grid 3; 9;  MP3
 };
 
+#include "display_variants/font_access.h"
+
 #endif
@@ -23,211 +23,258 @@
 #ifdef VFD_VARIANT_1
 
 #include "display_variants/variant_1_font.h"
+
+/**
+ * Physical layout of the character slots, indexed from the LAST displayed character
+ * (slot 0 is at the cursor address, slot 1 at the next address, etc.).
+ * The glyph of a slot is shifted right by `shift` bits in its byte;
+ * the bits shifted out (`carry_mask` of the glyph) are moved to the top bits
+ * of the byte of the previous slot.
+ * Ex: The 2nd character of the 1st grid starts on bit 2: its bit 1 is on bit 8 of the 1st character.
+ */
+typedef struct {
+    uint8_t shift;
+    uint8_t carry_mask;
+} vfd_slot_t;
+
+static const vfd_slot_t SLOTS[VFD_DISPLAYABLE_DIGITS] = {
+    {0, 0x00}, // Slot 0
+    {1, 0x01}, // Slot 1: the bit 1 is on the bit 8 of the slot 0
+    {0, 0x00}, // Slot 2
+    {0, 0x00}, // Slot 3
+    {0, 0x00}, // Slot 4
+    {0, 0x00}, // Slot 5
+    {0, 0x00}, // Slot 6
+};
+
+// Bit of the colon/dot symbol displayed after a character
+#define VFD_COLON_MARK  0x80
+
+/**
+ * @brief Lay glyphs out in the bytes of their slots.
+ * @param bytes Bytes from the cursor address (slot 0 first); count bytes are written.
+ * @param glyphs Glyphs in reading order: the first one is in the slot count - 1,
+ *      the last one at the cursor address (see SLOTS).
+ * @param count Number of glyphs; value range 0..VFD_DISPLAYABLE_DIGITS.
+ */
+static void layoutGlyphs(uint8_t *bytes, const uint8_t *glyphs, uint8_t count)
+{
+    uint8_t carry = 0;
+    for (uint8_t index = 0; index < count; index++) {
+        uint8_t slot = count - 1 - index;
+        const vfd_slot_t *layout = &SLOTS[slot];
+
+        bytes[slot] = (glyphs[index] >> layout->shift) | carry;
+        // Bits moved to the byte of the next slot (slot - 1)
+        carry = (glyphs[index] & layout->carry_mask) << (8 - layout->shift);
+    }
+}
+
+
+/**
+ * @brief Place bytes in the shadow framebuffer from the cursor address
+ *      and send them to the controller.
+ */
+static void placeBytes(const uint8_t *bytes, uint8_t count)
+{
+    uint8_t address = (grid_cursor * PT6312_BYTES_PER_GRID) - PT6312_BYTES_PER_GRID;
+    for (uint8_t i = 0; i < count; i++)
+        VFD_setBufferByte(address + i, bytes[i]);
+
+    // Send the modified bytes to the controller
+    VFD_flush();
+}
+
+
+/**
+ * @brief Place glyphs in the shadow framebuffer and send them to the controller.
+ * @see layoutGlyphs()
+ */
+static void placeGlyphs(const uint8_t *glyphs, uint8_t count)
+{
+    uint8_t bytes[VFD_DISPLAYABLE_DIGITS];
+
+    layoutGlyphs(bytes, glyphs, count);
+    placeBytes(bytes, count);
+}
+
+
+/**
+ * @brief Render a string in the bytes of the display memory (If VARIANT_1 is defined in global.h);
+ *      used by VFD_writeString() and PT6312Display::writeString().
+ * @param bytes Bytes from the address of the grid position; VFD_DISPLAYABLE_DIGITS at most.
+ * @param string See VFD_writeString().
+ * @param colon_symbol Not used by this display (see ':' in the string).
+ * @param position Grid cursor; not modified by this display.
+ * @return Number of bytes rendered.
+ */
+uint8_t VFD_renderString(uint8_t *bytes, const char *string, bool colon_symbol, uint8_t &position)
+{
+    uint8_t glyphs[VFD_DISPLAYABLE_DIGITS];
+    uint8_t count = 0;
+
+    (void)colon_symbol;
+    (void)position;
+
+    // Get the glyphs and the colon symbols
+    while ((*string > '\0') && (count < VFD_DISPLAYABLE_DIGITS)) {
+        if (*string == ':') {
+            if (count > 0)
+                glyphs[count - 1] |= VFD_COLON_MARK;
+        } else {
+            glyphs[count++] = VFD_fontLSB(*string);
+        }
+        string++;
+    }
+
+    layoutGlyphs(bytes, glyphs, count);
+    return count;
+}
+
+
 /**
  * @brief Write a string of characters present in the font (If VARIANT_1 is defined in global.h).
- * @param string String must be null terminated '\0'. Grid cursor is auto-incremented.
- *          For this display 6 characters can be displayed simultaneously.
- *          For positions 3 and 4, the grids accept 2 characters.
- *          Positions 1 and 2 accept only 1 char (segments of LSB only),
- *          the other positions are reserved for icons.
- * @param colon_symbol Boolean set to true to display the special colon symbol
- *          segment on grid 4.
- *          The symbol is displayed between chars 4 and 5.
+ * @param string String must be null terminated '\0'.
+ *          For this display VFD_DISPLAYABLE_DIGITS characters can be displayed simultaneously,
+ *          1 per byte; the last character is written at the cursor address,
+ *          the previous ones at the following addresses.
+ *          A ':' is not a character: it lights the colon symbol after the previous character.
+ *          Ex: "114:03:05". Extra characters are ignored.
+ * @param colon_symbol Not used by this display (see ':' in the string).
  * @warning The string MUST be null terminated.
  */
 void VFD_writeString(const char *string, bool colon_symbol)
 {
-    // Teste de ordenação
-    int index = 0;   // Valor do Indice Completo.
-    int H_point=0;   // Onde apareceu o ponto ":"
-    bool bt1 = false;
-    bool bt2 = false;
-    int id = 0;      // Valor de Indice sem o caractere ':'.
-    while (string[index] != '\0'){
-        //
-        if (string[index] == ':'){
-           id--;
-        }
-        index++;
-        id++;
-    }
-    uint8_t txt[id];
+    uint8_t bytes[VFD_DISPLAYABLE_DIGITS];
+
+    placeBytes(bytes, VFD_renderString(bytes, string, colon_symbol, grid_cursor));
+}
+
+
+/**
+ * @brief Write a fixed-point number without floating-point code (If VARIANT_1 is defined in global.h).
+ *      The decimal point is the colon/dot symbol of the digit before it,
+ *      lit only if the display has one at this address (see VFD_DP_MAP).
+ * @param value Scaled integer: the displayed number is value / 10^frac_digits.
+ *      Ex: VFD_writeFixed(1205, 2, 5); displays " 12.05".
+ * @param frac_digits Number of digits after the point (0..9).
+ * @param width Number of characters, the minus sign included (the point doesn't use a character).
+ *      Value range 1..VFD_DISPLAYABLE_DIGITS.
+ * @see VFD_formatFixed() for the padding and the overflow.
+ */
+void VFD_writeFixed(int32_t value, uint8_t frac_digits, uint8_t width)
+{
+    char    string[VFD_DISPLAYABLE_DIGITS + 1];
+    uint8_t glyphs[VFD_DISPLAYABLE_DIGITS] = {0};
+
+    if (width > VFD_DISPLAYABLE_DIGITS)
+        width = VFD_DISPLAYABLE_DIGITS;
 
-    // Limitando o tamanho da exibição aos digitos disponiveis no display.
-    if (id > VFD_DISPLAYABLE_DIGITS){
-        id = VFD_DISPLAYABLE_DIGITS;
+    frac_digits = VFD_formatFixed(string, value, frac_digits, width);
+
+    for (uint8_t index = 0; index < width; index++) {
+        glyphs[index] = VFD_fontLSB(string[index]);
     }
-    //
-    //// Loop de tratamento de caracteres e de envio de dados para o display.
-    for (int i=0; i<id; ++i)
-    {
-        // Serial.print("\n");
-        // Serial.print("  Inicio: ");
-        // Serial.print(i);
-        // Serial.print(" === ");
-        // Serial.print(string[i]);
-        // Serial.print("\n");
-        // String Exibida "114:03:05"
-        /////////////////////////////////
-        if (H_point>3 || bt1 || bt2)
-        {
-            if (bt1)
-            {
-                txt[i] |= FONT[string[i] - 0x20][1];
-                bt1 = false;
-            }
-            if (bt2)
-            {
-                txt[i] |= FONT[string[i+2] - 0x20][1];
-                bt2 = false;
-            }
-            if (H_point>3)
-            {
-                txt[i] = FONT[string[i+2] - 0x20][1]; // Atribui a esse indice o valor de duas casas à frente na *stiring.
-            }
-
-        }else if (H_point>0)
-        {
-            txt[i] = FONT[string[i+1] - 0x20][1]; // Atribui a esse indice o valor do seguinte.
-        }else
-        {
-            txt[i] = FONT[string[i] - 0x20][1];
-        }
-        /////////////////////////////////
-        if (string[i] == ':') // Corrigindo e imprimindo sinal de ':' no display.
-        {
-            if (i>4) // Condiciona para que imprima os ultimos caracteres da forma certa.
-            {
-                txt[i-2] |= 0b10000000; // i-2 por que ja apareceu um ponto antes, e deslocou um dos digitos uma casa a frente.
-                txt[i-1] = FONT[string[i+1] - 0x20][1]; // Atribui a esse indice o valor uma casa à frente no indice anterior
-                H_point = i;
-            }else
-            {
-                txt[i-1] |= 0b10000000;
-                txt[i] = FONT[string[i+1] - 0x20][1]; // Atribui a esse indice o valor do seguinte.
-                H_point = i;
-            }
 
-        }
-        /////////////////////////////////
-        if (i == id-2) // Corrige erro no segundo digito da 1ª grade.
-        {
-            if (txt[i] & 0b0000001)
-            {
-                txt[i+1] = 0b10000000;
-                bt1 = true;
-            }
-            txt[i] = txt[i] >> 1;     // Desloca à direita 1 bit, para corrigir o display.
-
-        }else if (H_point >= id-2)    // Caso o segundo digito tenha sido definido na linha 101.
-        {
-            txt[i-1] = txt[i-1] >> 1; // Desloca à direita 1 bit, para corrigir o display.
-            txt[i] |= 0b10000000;     // Reativa o bit 1 desativado no deslocamento feito acima.
-        }
-        /////////////////////////////////
-        if (i == id-1) // Parte Final.
-        {
-            // Print for debug.
-            // for (int a=0; a<id; ++a)
-            // {
-            //     Serial.print("  Indice: ");
-            //     Serial.print(a);
-            //     Serial.print(" = ");
-            //     Serial.print(txt[a],BIN);
-            // }
-            for (int x=id-1; x>=0; x--) // Roda todos os comandos de uma vez.
-            {
-                VFD_command(txt[x], false);
-            }
-        }
-        /////////////////////////////////
+    if (frac_digits) {
+        // The digit before the point is in the slot frac_digits
+        uint8_t address = (grid_cursor * PT6312_BYTES_PER_GRID) - PT6312_BYTES_PER_GRID + frac_digits;
+        if ((VFD_DP_MAP >> address) & 1)
+            glyphs[width - frac_digits - 1] |= VFD_COLON_MARK;
     }
-    //Serial.println();
-
-    /*
-    while (*string > '\0') { // TODO: security test cursor <= VFD_GRIDS//DISPLAYABLE
-        Serial.println(string - 0x20);
-        if ((grid_cursor == 1) || (grid_cursor == 2) || (grid_cursor == 3)) {
-            // Cursor positions: 3 or 4: 2 chars per grid
-            // MSB: Get LSB of left/1st char
-            msb_byte = FONT[*string - 0x20][1];
-            //Serial.print("MSB_byte: ");
-            //Serial.print(msb_byte, BIN);
-            //Serial.println();
-            string++;
-            // Test char validity
-            if (*string > '\0') {
-                // LSB: Get LSB of right/2nd char
-                lsb_byte = FONT[*string - 0x20][1];
-                //Serial.print("LSB_byte: ");
-                //Serial.println(lsb_byte, BIN);
-                //Serial.println();
-            } else {
-                lsb_byte = 0;
-                string--; // Allow end of while loop
-            }
-
-            // Corrige erro do meu display!!
-            if (grid_cursor == 1){
-
-                if (lsb_byte & 0b00000001){
-                    msb_byte |= 0b10000000;
-                }
-                lsb_byte = lsb_byte >> 1;
-            }
-
-            // Set optional colon symbol
-            if (colon_symbol && grid_cursor == 1){
-                #if VFD_COLON_SYMBOL_BIT > 8
-                // Add the symbol on the MSB part of the grid
-                msb_byte |= 1 << (VFD_COLON_SYMBOL_BIT - 9);
-                #else // < 9
-                // Add the symbol on the LSB part of the grid
-                lsb_byte |= 1 << (VFD_COLON_SYMBOL_BIT - 1);
-                #endif
-            }
-        }else{
-            // Cursor positions: 1 or 2: 1 char only
-            // TODO: set only the LSB part to avoid erasing MSB part ?
-            // Send LSB
-            lsb_byte = FONT[*string - 0x20][1];
-            // Send MSB
-            msb_byte = FONT[*string - 0x20][0];
-        }
 
-        /*
-        #if ENABLE_ICON_BUFFER == 1
-        // Merge icons and char data
-        uint8_t memory_addr = (grid_cursor * PT6312_BYTES_PER_GRID) - PT6312_BYTES_PER_GRID;
-        VFD_command(lsb_byte | iconDisplayBuffer[memory_addr], false);
-        VFD_command(msb_byte | iconDisplayBuffer[memory_addr + 1], false);
-        #else
-        VFD_command(lsb_byte, false);
-        VFD_command(msb_byte, false);
-        #endif
+    placeGlyphs(glyphs, width);
+}
 
 
-        //VFD_command(msb_byte, false);
-        //VFD_command(lsb_byte, false);
-        texto_lsb[id] = msb_byte;
-        texto_msb[id] = lsb_byte;
+/**
+ * @brief Render 1 character of the display (If VARIANT_1 is defined in global.h);
+ *      used by VFD_writeCharAt() and PT6312Display::writeCharAt().
+ *      The slots of the line start at the address 0 (see SLOTS).
+ * @param position See VFD_writeCharAt().
+ * @param character Character present in the font.
+ * @param mask Segments of the character (see VFD_writeBytesAt()).
+ * @param value New state of these segments.
+ * @return Address of the 1st byte to modify, VFD_RENDER_NONE if the position is invalid.
+ */
+uint8_t VFD_renderCharAt(uint8_t position, char character, uint16_t &mask, uint16_t &value)
+{
+    if ((position == 0) || (position > VFD_DISPLAYABLE_DIGITS))
+        return VFD_RENDER_NONE;
 
+    uint8_t slot  = VFD_DISPLAYABLE_DIGITS - position;
+    uint8_t glyph = VFD_fontLSB(character) & ~VFD_COLON_MARK;
+    const vfd_slot_t *layout = &SLOTS[slot];
 
-        grid_cursor++;
-        string++;
-        id++;
+    uint8_t address = slot;
+    mask  = (uint8_t)~VFD_COLON_MARK >> layout->shift;
+    value = glyph >> layout->shift;
+    if (layout->carry_mask) {
+        // Bits moved to the top bits of the byte of the previous slot
+        address--;
+        mask  = (mask << 8) | (layout->carry_mask << (8 - layout->shift));
+        value = (value << 8) | ((glyph & layout->carry_mask) << (8 - layout->shift));
     }
-    */
-
-    /*for (int i=0; i<index; i++){
-        VFD_command(texto_msb[index-i], false);
-        VFD_command(texto_msb[index-i], false);
-    }*/
-    // Signal the driver that the data transmission is over
-    VFD_CSSignal();
+    return address;
+}
+
+
+/**
+ * @brief Write 1 character without rewriting the line (If VARIANT_1 is defined in global.h).
+ *      Only the segments of the character are modified: the other characters and
+ *      the colon/dot symbols are preserved; only the modified bytes are sent.
+ *      The grid cursor is not modified.
+ * @param position Character from the left of the display, whatever the grid cursor
+ *      (i.e. of a line written by VFD_writeString() after VFD_home()):
+ *      value range 1..VFD_DISPLAYABLE_DIGITS. Other positions are ignored.
+ * @param character Character present in the font.
+ * @see VFD_writeBytesAt()
+ */
+void VFD_writeCharAt(uint8_t position, char character)
+{
+    uint16_t mask = 0, value = 0;
+    uint8_t  address = VFD_renderCharAt(position, character, mask, value);
+
+    VFD_writeBytesAt(address, mask, value);
 }
 
 
+/**
+ * Frames of the spinning circle (see VFD_playFrame()), on 1 byte
+ * Left shifts notes from segment number to bit number (msb: segment number -8 -1).
+ * Segments successively displayed with 100% of the duty cycle of 1 frame:
+ * 11, 12, 13, 14, 15, 16
+ * The 3 segments that precede the main displayed segment are fading more and more pronounced
+ * (1/2, 1/5, 1/12 duty cycles).
+ */
+static const uint8_t SPINNER_FRAMES[] PROGMEM = {
+    6, 70, 1,
+    VFD_ANIM_LAST_ELEMENT(0, 1, 1 << (11 - 8 - 1)),     // segment 11 (first)
+
+    VFD_ANIM_ELEMENT(0, 1, 1 << (12 - 8 - 1)),          // segment 12 (second)
+    VFD_ANIM_LAST_ELEMENT(0, 2, 1 << (11 - 8 - 1)),
+
+    VFD_ANIM_ELEMENT(0, 1, 1 << (13 - 8 - 1)),          // segment 13 (third)
+    VFD_ANIM_ELEMENT(0, 2, 1 << (12 - 8 - 1)),
+    VFD_ANIM_LAST_ELEMENT(0, 5, 1 << (11 - 8 - 1)),
+
+    VFD_ANIM_ELEMENT(0, 1, 1 << (14 - 8 - 1)),          // segment 14 (fourth)
+    VFD_ANIM_ELEMENT(0, 2, 1 << (13 - 8 - 1)),
+    VFD_ANIM_ELEMENT(0, 5, 1 << (12 - 8 - 1)),
+    VFD_ANIM_LAST_ELEMENT(0, 12, 1 << (11 - 8 - 1)),
+
+    VFD_ANIM_ELEMENT(0, 1, 1 << (15 - 8 - 1)),          // segment 15 (fifth)
+    VFD_ANIM_ELEMENT(0, 2, 1 << (14 - 8 - 1)),
+    VFD_ANIM_ELEMENT(0, 5, 1 << (13 - 8 - 1)),
+    VFD_ANIM_LAST_ELEMENT(0, 12, 1 << (12 - 8 - 1)),
+
+    VFD_ANIM_ELEMENT(0, 1, 1 << (16 - 8 - 1)),          // segment 16 (sixth)
+    VFD_ANIM_ELEMENT(0, 2, 1 << (15 - 8 - 1)),
+    VFD_ANIM_ELEMENT(0, 5, 1 << (14 - 8 - 1)),
+    VFD_ANIM_LAST_ELEMENT(0, 12, 1 << (13 - 8 - 1)),
+};
+
+
 /**
  * @brief Animation for a busy spinning circle that uses 1 byte (half grid).
  * @param address Memory address on the controller where the animation frames must be set.
@@ -252,6 +299,7 @@ void VFD_writeString(const char *string, bool colon_symbol)
  *      Ex: For 16th main segment:
  *          15, 14, 13 are displayed, from the most marked to the darkest;
  *          the others are not displayed (12, 11).
+ *      The frames are described in SPINNER_FRAMES and played by VFD_playFrame().
  * @warning Since a specific address is used, the grid_cursor global variable IS NOT updated,
  *      and is thus more synchronized with the controller memory.
  *      You SHOULD NOT rely on this value after using this function and use
@@ -260,96 +308,7 @@ void VFD_writeString(const char *string, bool colon_symbol)
  */
 void VFD_busySpinningCircle(uint8_t address, uint8_t& frame_number, uint8_t& loop_number)
 {
-    uint8_t msb = 0;
-    // Init duty cycles divisors
-    uint8_t seg2_duty_cycle = 2, seg3_duty_cycle = 5, seg4_duty_cycle = 12;
-
-    // Compute duty cycles triggers
-    seg2_duty_cycle = loop_number % seg2_duty_cycle; // 1/2
-    seg3_duty_cycle = loop_number % seg3_duty_cycle; // 1/5
-    seg4_duty_cycle = loop_number % seg4_duty_cycle; // 1/12
-
-    // Left shifts notes from segment number to bit number:
-    // msb: segment number -8 -1
-    // lsb: segment number -1
-    // Segments successively displayed with 100% of the duty cycle of 1 frame:
-    // 11, 12, 13, 14, 15, 16
-    // The 3 segments that precede the main displayed segment are fading more and more pronounced.
-    if (frame_number == 1) {
-        msb = 1 << (11 - 8 - 1);      // segment 11 (first)
-    }else if (frame_number == 2) {
-        msb = 1 << (12 - 8 - 1);      // segment 12 (second)
-        if (seg2_duty_cycle == 0) {
-            msb |= 1 << (11 - 8 - 1); // segment 11
-        }
-    }else if (frame_number == 3) {
-        msb = 1 << (13 - 8 - 1);      // segment 13 (third)
-        if (seg2_duty_cycle == 0) {
-            msb |= 1 << (12 - 8 - 1); // segment 12
-        }
-        if (seg3_duty_cycle == 0) {
-            msb |= 1 << (11 - 8 - 1); // segment 11
-        }
-    }else if (frame_number == 4) {
-        msb = 1 << (14 - 8 - 1);      // segment 14 (fourth)
-        if (seg2_duty_cycle == 0) {
-            msb |= 1 << (13 - 8 - 1); // segment 13
-        }
-        if (seg3_duty_cycle == 0) {
-            msb |= 1 << (12 - 8 - 1); // segment 12
-        }
-        if (seg4_duty_cycle == 0) {
-            msb |= 1 << (11 - 8 - 1); // segment 11
-        }
-    }else if (frame_number == 5) {
-        msb = 1 << (15 - 8 - 1);      // segment 15 (fifth)
-        if (seg2_duty_cycle == 0) {
-            msb |= 1 << (14 - 8 - 1); // segment 14
-        }
-        if (seg3_duty_cycle == 0) {
-            msb |= 1 << (13 - 8 - 1); // segment 13
-        }
-        if (seg4_duty_cycle == 0) {
-            msb |= 1 << (12 - 8 - 1); // segment 12
-        }
-    }else if (frame_number == 6) {
-        msb = 1 << (16 - 8 - 1);      // segment 16 (sixth)
-        if (seg2_duty_cycle == 0) {
-            msb |= 1 << (15 - 8 - 1); // segment 15
-        }
-        if (seg3_duty_cycle == 0) {
-            msb |= 1 << (14 - 8 - 1); // segment 14
-        }
-        if (seg4_duty_cycle == 0) {
-            msb |= 1 << (13 - 8 - 1); // segment 13
-        }
-    }
-
-    loop_number++;
-    if (loop_number == 70) {
-        if (frame_number == 6) {
-            frame_number = 0;
-        }
-        frame_number++;
-        loop_number = 0;
-    }
-
-    #if ENABLE_ICON_BUFFER == 1
-    VFD_writeByte(address, msb | iconDisplayBuffer[address]);
-    #else
-    VFD_writeByte(address, msb);
-    #endif
-
-    // If the spinning circle was on 2 bytes, lsb and msb should be sent.
-    // Ex:
-    // VFD_command(lsb, false);
-    // VFD_command(msb, false);
-    // VFD_CSSignal();
-    // grid_cursor++;
-
-    // Reset/Update display
-    // => Don't know why but it appears to be mandatory to avoid forever black screen... (?)
-    VFD_resetDisplay();
+    VFD_playFrame(SPINNER_FRAMES, address, frame_number, loop_number);
 }
 
 #endif
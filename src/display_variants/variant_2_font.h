@@ -22,6 +22,7 @@
 #define FONT_H
 
 #include "PT6312.h"
+#include "display_variants/font_builder.h"
 // Segment numbering for ET16312n VFD driver
 //         7
 //     ---------
@@ -37,86 +38,119 @@
 //
 // ASCII codes starting to 0x20 offset (space character)
 #define VFD_COLON_SYMBOL_BIT    10
-const uint8_t FONT[65][2] = {
-    {0b00000000, 0b00000000}, // space 0x20
-    {0b00000000, 0b00000000}, // ! N/A
-    {0b00000000, 0b00000000}, // " N/A
-    {0b00000000, 0b00000000}, // # N/A
-    {0b11000101, 0b01100011}, // $ (bits 16, 15, 11, 9, 7, 6, 2, 1)
-    {0b00000000, 0b00000000}, // % N/A
-    {0b00000000, 0b00000000}, // & N/A
-    {0b00000000, 0b00000000}, // ' N/A
-    {0b00001001, 0b00001000}, // ( (bits 12, 9, 4)
-    {0b00010001, 0b00010000}, // ) (bits 13, 9, 5)
-    {0b10011001, 0b00111001}, // * (bits 16, 13, 12, 9, 6, 5, 4, 1)
-    {0b10000001, 0b00100001}, // + (bits 16, 9, 6, 1)
-    {0b00000000, 0b00000000}, // , N/A
-    {0b10000001, 0b00000001}, // - (bits 16, 9, 1)
-    {0b00000001, 0b00000000}, // . (bit 9)
-    {0b00010001, 0b00001000}, // / (bits 13, 9, 4)
-    {0b01110100, 0b01001110}, // 0 (bits 15, 14, 13, 11, 7, 4, 3, 2)
-    {0b01000000, 0b00001100}, // 1 (bits 15, 4, 3)
-    {0b10100101, 0b01000101}, // 2 (bits 16, 14, 11, 9, 7, 3, 1)
-    {0b11000101, 0b01000101}, // 3 (bits 16, 15, 11, 9, 7, 3, 1)
-    {0b11000001, 0b00000111}, // 4 (bits 16, 15, 9, 3, 2, 1)
-    {0b11000101, 0b01000011}, // 5 (bits 16, 15, 11, 9, 7, 2, 1)
-    {0b11100101, 0b01000011}, // 6 (bits 16, 15, 14, 11, 9, 7, 2, 1)
-    {0b00010001, 0b01001000}, // 7 (bits 13, 9, 7, 4)
-    {0b11100101, 0b01000111}, // 8 (bits 16, 15, 14, 11, 9, 7, 3, 2, 1)
-    {0b11000101, 0b01000111}, // 9 (bits 16, 15, 11, 9, 7, 3, 2, 1)
-    {0b00000010, 0b00000000}, // : (bit 10)  available for 3-th and 5-th digits only
-    {0b00000000, 0b00000000}, // ; N/A
-    {0b00001000, 0b00001000}, // < (bits 12, 4)
-    {0b10000101, 0b00000001}, // = (bits 16, 11, 9, 1)
-    {0b00010000, 0b00010000}, // > (bits 13, 5)
-    {0b00000000, 0b00000000}, // ? N/A
-    {0b00000000, 0b00000000}, // @ N/A
-    {0b11100001, 0b01000111}, // A (bits 16, 15, 14, 9, 7, 3, 2, 1)
-    {0b01000101, 0b01100101}, // B (bits 15, 11, 9, 7, 6, 3, 1)
-    {0b00100100, 0b01000010}, // C (bits 14, 11, 7, 2)
-    {0b01000101, 0b01100100}, // D (bits 15, 11, 9, 7, 6, 3)
-    {0b10100101, 0b01000011}, // E (bits 16, 14, 11, 9, 7, 2, 1)
-    {0b10100001, 0b01000010}, // F (bits 16, 14, 9, 7, 2)
-    {0b01100100, 0b01000011}, // G (bits 15, 14, 11, 7, 2, 1)
-    {0b11100001, 0b00000111}, // H (bits 16, 15, 14, 9, 3, 2, 1)
-    {0b00000001, 0b00100000}, // I (bits 9, 6)
-    {0b01100100, 0b00000100}, // J (bits 15, 14, 11, 3)
-    {0b10101001, 0b00001010}, // K (bits 16, 14, 12, 9, 4, 2)
-    {0b00100100, 0b00000010}, // L (bits 14, 11, 2)
-    {0b01100000, 0b00011110}, // M (bits 15, 14, 5, 4, 3, 2)
-    {0b01101001, 0b00010110}, // N (bits 15, 14, 12, 9, 5, 3, 2)
-    {0b01100100, 0b01000110}, // O (bits 15, 14, 11, 7, 3, 2)
-    {0b10100001, 0b01000111}, // P (bits 16, 14, 9, 7, 3, 2, 1)
-    {0b01101100, 0b01000110}, // Q (bits 15, 14, 12, 11, 7, 3, 2)
-    {0b10101001, 0b01000111}, // R (bits 16, 14, 12, 9, 7, 3, 2, 1)
-    {0b11000101, 0b01000011}, // S (bits 16, 15, 11, 9, 7, 2, 1)
-    {0b00000001, 0b01100000}, // T (bits 9, 7, 6)
-    {0b01100100, 0b00000110}, // U (bits 15, 14, 11, 3, 2)
-    {0b00110000, 0b00001010}, // V (bits 14, 13, 4, 2)
-    {0b01111001, 0b00000110}, // W (bits 15, 14, 13, 12, 9, 3, 2)
-    {0b00011001, 0b00011000}, // X (bits 13, 12, 9, 5, 4)
-    {0b00010001, 0b00011000}, // Y (bits 13, 9, 5, 4)
-    {0b00010101, 0b01001000}, // Z (bits 13, 11, 9, 7, 4)
-    {0b00100100, 0b01000010}, // [ (bits 14, 11, 7, 2)
-    {0b00001001, 0b00010000}, // \ (bits 12, 9, 5)
-    {0b01000100, 0b01000100}, // ] (bits 15, 11, 7, 3)
-    {0b00000000, 0b00000000}, // ^ N/A
-    {0b00000100, 0b00000000}, // _ (bits 11)
+
+// Segment numbers (starting from 1)
+enum {
+    SEG_MID_RIGHT   = 1,
+    SEG_UPPER_LEFT  = 2,
+    SEG_UPPER_RIGHT = 3,
+    SEG_DIAG_UR     = 4,
+    SEG_DIAG_UL     = 5,
+    SEG_VERTICAL    = 6,
+    SEG_TOP         = 7,
+    SEG_CENTER      = 9,
+    SEG_COLON       = VFD_COLON_SYMBOL_BIT,
+    SEG_BOTTOM      = 11,
+    SEG_DIAG_LR     = 12,
+    SEG_DIAG_LL     = 13,
+    SEG_LOWER_LEFT  = 14,
+    SEG_LOWER_RIGHT = 15,
+    SEG_MID_LEFT    = 16,
+};
+VFD_CHECK_SEGMENTS(SEG_MID_RIGHT, SEG_UPPER_LEFT, SEG_UPPER_RIGHT, SEG_DIAG_UR, SEG_DIAG_UL,
+                   SEG_VERTICAL, SEG_TOP, SEG_CENTER, SEG_COLON, SEG_BOTTOM, SEG_DIAG_LR,
+                   SEG_DIAG_LL, SEG_LOWER_LEFT, SEG_LOWER_RIGHT, SEG_MID_LEFT);
+
+const uint8_t FONT[65][2] PROGMEM = {
+    VFD_GLYPH(), // space 0x20
+    VFD_GLYPH(), // ! N/A
+    VFD_GLYPH(), // " N/A
+    VFD_GLYPH(), // # N/A
+    VFD_GLYPH(SEG_TOP, SEG_UPPER_LEFT, SEG_VERTICAL, SEG_MID_LEFT, SEG_CENTER, SEG_MID_RIGHT, SEG_LOWER_RIGHT, SEG_BOTTOM), // $
+    VFD_GLYPH(), // % N/A
+    VFD_GLYPH(), // & N/A
+    VFD_GLYPH(), // ' N/A
+    VFD_GLYPH(SEG_DIAG_UR, SEG_CENTER, SEG_DIAG_LR), // (
+    VFD_GLYPH(SEG_DIAG_UL, SEG_CENTER, SEG_DIAG_LL), // )
+    VFD_GLYPH(SEG_DIAG_UL, SEG_VERTICAL, SEG_DIAG_UR, SEG_MID_LEFT, SEG_CENTER, SEG_MID_RIGHT, SEG_DIAG_LL, SEG_DIAG_LR), // *
+    VFD_GLYPH(SEG_VERTICAL, SEG_MID_LEFT, SEG_CENTER, SEG_MID_RIGHT), // +
+    VFD_GLYPH(), // , N/A
+    VFD_GLYPH(SEG_MID_LEFT, SEG_CENTER, SEG_MID_RIGHT), // -
+    VFD_GLYPH(SEG_CENTER), // .
+    VFD_GLYPH(SEG_DIAG_UR, SEG_CENTER, SEG_DIAG_LL), // /
+    VFD_GLYPH(SEG_TOP, SEG_UPPER_LEFT, SEG_DIAG_UR, SEG_UPPER_RIGHT, SEG_LOWER_LEFT, SEG_DIAG_LL, SEG_LOWER_RIGHT, SEG_BOTTOM), // 0
+    VFD_GLYPH(SEG_DIAG_UR, SEG_UPPER_RIGHT, SEG_LOWER_RIGHT), // 1
+    VFD_GLYPH(SEG_TOP, SEG_UPPER_RIGHT, SEG_MID_LEFT, SEG_CENTER, SEG_MID_RIGHT, SEG_LOWER_LEFT, SEG_BOTTOM), // 2
+    VFD_GLYPH(SEG_TOP, SEG_UPPER_RIGHT, SEG_MID_LEFT, SEG_CENTER, SEG_MID_RIGHT, SEG_LOWER_RIGHT, SEG_BOTTOM), // 3
+    VFD_GLYPH(SEG_UPPER_LEFT, SEG_UPPER_RIGHT, SEG_MID_LEFT, SEG_CENTER, SEG_MID_RIGHT, SEG_LOWER_RIGHT), // 4
+    VFD_GLYPH(SEG_TOP, SEG_UPPER_LEFT, SEG_MID_LEFT, SEG_CENTER, SEG_MID_RIGHT, SEG_LOWER_RIGHT, SEG_BOTTOM), // 5
+    VFD_GLYPH(SEG_TOP, SEG_UPPER_LEFT, SEG_MID_LEFT, SEG_CENTER, SEG_MID_RIGHT, SEG_LOWER_LEFT, SEG_LOWER_RIGHT, SEG_BOTTOM), // 6
+    VFD_GLYPH(SEG_TOP, SEG_DIAG_UR, SEG_CENTER, SEG_DIAG_LL), // 7
+    VFD_GLYPH(SEG_TOP, SEG_UPPER_LEFT, SEG_UPPER_RIGHT, SEG_MID_LEFT, SEG_CENTER, SEG_MID_RIGHT, SEG_LOWER_LEFT, SEG_LOWER_RIGHT, SEG_BOTTOM), // 8
+    VFD_GLYPH(SEG_TOP, SEG_UPPER_LEFT, SEG_UPPER_RIGHT, SEG_MID_LEFT, SEG_CENTER, SEG_MID_RIGHT, SEG_LOWER_RIGHT, SEG_BOTTOM), // 9
+    VFD_GLYPH(SEG_COLON), // : available for 3-th and 5-th digits only
+    VFD_GLYPH(), // ; N/A
+    VFD_GLYPH(SEG_DIAG_UR, SEG_DIAG_LR), // <
+    VFD_GLYPH(SEG_MID_LEFT, SEG_CENTER, SEG_MID_RIGHT, SEG_BOTTOM), // =
+    VFD_GLYPH(SEG_DIAG_UL, SEG_DIAG_LL), // >
+    VFD_GLYPH(), // ? N/A
+    VFD_GLYPH(), // @ N/A
+    VFD_GLYPH(SEG_TOP, SEG_UPPER_LEFT, SEG_UPPER_RIGHT, SEG_MID_LEFT, SEG_CENTER, SEG_MID_RIGHT, SEG_LOWER_LEFT, SEG_LOWER_RIGHT), // A
+    VFD_GLYPH(SEG_TOP, SEG_VERTICAL, SEG_UPPER_RIGHT, SEG_CENTER, SEG_MID_RIGHT, SEG_LOWER_RIGHT, SEG_BOTTOM), // B
+    VFD_GLYPH(SEG_TOP, SEG_UPPER_LEFT, SEG_LOWER_LEFT, SEG_BOTTOM), // C
+    VFD_GLYPH(SEG_TOP, SEG_VERTICAL, SEG_UPPER_RIGHT, SEG_CENTER, SEG_LOWER_RIGHT, SEG_BOTTOM), // D
+    VFD_GLYPH(SEG_TOP, SEG_UPPER_LEFT, SEG_MID_LEFT, SEG_CENTER, SEG_MID_RIGHT, SEG_LOWER_LEFT, SEG_BOTTOM), // E
+    VFD_GLYPH(SEG_TOP, SEG_UPPER_LEFT, SEG_MID_LEFT, SEG_CENTER, SEG_LOWER_LEFT), // F
+    VFD_GLYPH(SEG_TOP, SEG_UPPER_LEFT, SEG_MID_RIGHT, SEG_LOWER_LEFT, SEG_LOWER_RIGHT, SEG_BOTTOM), // G
+    VFD_GLYPH(SEG_UPPER_LEFT, SEG_UPPER_RIGHT, SEG_MID_LEFT, SEG_CENTER, SEG_MID_RIGHT, SEG_LOWER_LEFT, SEG_LOWER_RIGHT), // H
+    VFD_GLYPH(SEG_VERTICAL, SEG_CENTER), // I
+    VFD_GLYPH(SEG_UPPER_RIGHT, SEG_LOWER_LEFT, SEG_LOWER_RIGHT, SEG_BOTTOM), // J
+    VFD_GLYPH(SEG_UPPER_LEFT, SEG_DIAG_UR, SEG_MID_LEFT, SEG_CENTER, SEG_LOWER_LEFT, SEG_DIAG_LR), // K
+    VFD_GLYPH(SEG_UPPER_LEFT, SEG_LOWER_LEFT, SEG_BOTTOM), // L
+    VFD_GLYPH(SEG_UPPER_LEFT, SEG_DIAG_UL, SEG_DIAG_UR, SEG_UPPER_RIGHT, SEG_LOWER_LEFT, SEG_LOWER_RIGHT), // M
+    VFD_GLYPH(SEG_UPPER_LEFT, SEG_DIAG_UL, SEG_UPPER_RIGHT, SEG_CENTER, SEG_LOWER_LEFT, SEG_DIAG_LR, SEG_LOWER_RIGHT), // N
+    VFD_GLYPH(SEG_TOP, SEG_UPPER_LEFT, SEG_UPPER_RIGHT, SEG_LOWER_LEFT, SEG_LOWER_RIGHT, SEG_BOTTOM), // O
+    VFD_GLYPH(SEG_TOP, SEG_UPPER_LEFT, SEG_UPPER_RIGHT, SEG_MID_LEFT, SEG_CENTER, SEG_MID_RIGHT, SEG_LOWER_LEFT), // P
+    VFD_GLYPH(SEG_TOP, SEG_UPPER_LEFT, SEG_UPPER_RIGHT, SEG_LOWER_LEFT, SEG_DIAG_LR, SEG_LOWER_RIGHT, SEG_BOTTOM), // Q
+    VFD_GLYPH(SEG_TOP, SEG_UPPER_LEFT, SEG_UPPER_RIGHT, SEG_MID_LEFT, SEG_CENTER, SEG_MID_RIGHT, SEG_LOWER_LEFT, SEG_DIAG_LR), // R
+    VFD_GLYPH(SEG_TOP, SEG_UPPER_LEFT, SEG_MID_LEFT, SEG_CENTER, SEG_MID_RIGHT, SEG_LOWER_RIGHT, SEG_BOTTOM), // S
+    VFD_GLYPH(SEG_TOP, SEG_VERTICAL, SEG_CENTER), // T
+    VFD_GLYPH(SEG_UPPER_LEFT, SEG_UPPER_RIGHT, SEG_LOWER_LEFT, SEG_LOWER_RIGHT, SEG_BOTTOM), // U
+    VFD_GLYPH(SEG_UPPER_LEFT, SEG_DIAG_UR, SEG_LOWER_LEFT, SEG_DIAG_LL), // V
+    VFD_GLYPH(SEG_UPPER_LEFT, SEG_UPPER_RIGHT, SEG_CENTER, SEG_LOWER_LEFT, SEG_DIAG_LL, SEG_DIAG_LR, SEG_LOWER_RIGHT), // W
+    VFD_GLYPH(SEG_DIAG_UL, SEG_DIAG_UR, SEG_CENTER, SEG_DIAG_LL, SEG_DIAG_LR), // X
+    VFD_GLYPH(SEG_DIAG_UL, SEG_DIAG_UR, SEG_CENTER, SEG_DIAG_LL), // Y
+    VFD_GLYPH(SEG_TOP, SEG_DIAG_UR, SEG_CENTER, SEG_DIAG_LL, SEG_BOTTOM), // Z
+    VFD_GLYPH(SEG_TOP, SEG_UPPER_LEFT, SEG_LOWER_LEFT, SEG_BOTTOM), // [
+    VFD_GLYPH(SEG_DIAG_UL, SEG_CENTER, SEG_DIAG_LR), // \ (backslash)
+    VFD_GLYPH(SEG_TOP, SEG_UPPER_RIGHT, SEG_LOWER_RIGHT, SEG_BOTTOM), // ]
+    VFD_GLYPH(), // ^ N/A
+    VFD_GLYPH(SEG_BOTTOM), // _
 
     //Special non-standard symbols
-    {0b10000001, 0b01000111}  // degree (bits 16, 9, 7, 3, 2, 1) (index 64)
+    VFD_GLYPH(SEG_TOP, SEG_UPPER_LEFT, SEG_UPPER_RIGHT, SEG_MID_LEFT, SEG_CENTER, SEG_MID_RIGHT) // degree (index 64)
 };
 
 
+// Decimal point map (see VFD_writeFixed()): the point is the colon segment,
+// displayed between the grids 3 and 4, or 4 and 5.
+// {Grid of the digit before the point, grid of the segment, segment number}
+const uint8_t VFD_DP_MAP[][3] PROGMEM = {
+    {3, 3, SEG_COLON},
+    {4, 5, SEG_COLON},
+};
+
 // Shortcuts refering to the indexes in the table ICONS_FONT
 #define ICON_COLON_1      0
 #define ICON_COLON_2      1
 
 // LSB: grid number starting from 0
 // MSB: segment number starting from 0
-const uint8_t ICONS_FONT[] = {
+const uint8_t ICONS_FONT[] PROGMEM = {
     0b10010011, // Index 0:  Grid 3; 9;  Colon
     0b00010101, // Index 13: Grid 5; 9;  Colon
 };
 
+#include "display_variants/font_access.h"
+
 #endif
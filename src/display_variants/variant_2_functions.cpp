@@ -26,6 +26,60 @@
 #ifdef VFD_VARIANT_2
 
 #include "display_variants/variant_2_font.h"
+/**
+ * @brief Write a glyph in the shadow framebuffer at the grid cursor (with the icons
+ *      if ENABLE_ICON_BUFFER is set); the cursor is incremented.
+ * @param glyph MSB: segments 16..9, LSB: segments 8..1.
+ */
+static void placeGlyph(uint16_t glyph)
+{
+    uint8_t memory_addr = (grid_cursor * PT6312_BYTES_PER_GRID) - PT6312_BYTES_PER_GRID;
+
+    #if ENABLE_ICON_BUFFER == 1
+    VFD_setBufferByte(memory_addr, (uint8_t)glyph | iconDisplayBuffer[memory_addr]);
+    VFD_setBufferByte(memory_addr + 1, (glyph >> 8) | iconDisplayBuffer[memory_addr + 1]);
+    #else
+    VFD_setBufferByte(memory_addr, glyph);
+    VFD_setBufferByte(memory_addr + 1, glyph >> 8);
+    #endif
+
+    grid_cursor++;
+}
+
+
+/**
+ * @brief Render a string in the bytes of the display memory (If VARIANT_2 is defined in global.h);
+ *      used by VFD_writeString() and PT6312Display::writeString().
+ * @param bytes Bytes from the address of the grid position; VFD_RENDER_MAX_BYTES at most.
+ * @param string See VFD_writeString().
+ * @param colon_symbol See VFD_writeString().
+ * @param position Grid cursor; incremented for each character.
+ * @return Number of bytes rendered (2 per character).
+ */
+uint8_t VFD_renderString(uint8_t *bytes, const char *string, bool colon_symbol, uint8_t &position)
+{
+    uint8_t count = 0;
+
+    while (*string > '\0') {
+        uint16_t glyph = VFD_fontGlyph(*string);
+
+        // Set optional colon symbol
+        if (colon_symbol && ((position == 3) || (position == 5))) {
+            glyph |= 1 << (VFD_COLON_SYMBOL_BIT - 1);
+        }
+
+        // Characters beyond the display memory only move the cursor
+        if (count < VFD_RENDER_MAX_BYTES) {
+            bytes[count++] = glyph;
+            bytes[count++] = glyph >> 8;
+        }
+        position++;
+        string++;
+    }
+    return count;
+}
+
+
 /**
  * @brief Write a string of characters present in the font (If VARIANT_2 is defined in global.h).
  * @param string String must be null terminated '\0'. Grid cursor is auto-incremented.
@@ -37,53 +91,150 @@
  */
 void VFD_writeString(const char *string, bool colon_symbol)
 {
-    uint8_t chrset;
-
-    while (*string > '\0') { // TODO: security test cursor <= VFD_GRIDS
-        // Send LSB
-        chrset = FONT[*string - 0x20][1];
-
-        #if VFD_COLON_SYMBOL_BIT < 9
-        // Set optional colon symbol (if its bit number is < 9, starting from 1)
-        if (colon_symbol && ((grid_cursor == 3) || (grid_cursor == 5))) {
-            // Add the symbol on the MSB part of the byte
-            chrset |= 1 << (VFD_COLON_SYMBOL_BIT - 1);
-        }
-        #endif
+    uint8_t bytes[VFD_RENDER_MAX_BYTES];
+    uint8_t memory_addr = (grid_cursor * PT6312_BYTES_PER_GRID) - PT6312_BYTES_PER_GRID;
+    uint8_t count       = VFD_renderString(bytes, string, colon_symbol, grid_cursor);
 
+    for (uint8_t i = 0; (i < count) && (memory_addr < PT6312_DISPLAY_MEM); i++, memory_addr++) {
         #if ENABLE_ICON_BUFFER == 1
-        uint8_t memory_addr = (grid_cursor * PT6312_BYTES_PER_GRID) - PT6312_BYTES_PER_GRID;
-        VFD_command(chrset | iconDisplayBuffer[memory_addr], false);
+        VFD_setBufferByte(memory_addr, bytes[i] | iconDisplayBuffer[memory_addr]);
         #else
-        VFD_command(chrset, false);
+        VFD_setBufferByte(memory_addr, bytes[i]);
         #endif
+    }
 
-        // Send MSB
-        chrset = FONT[*string - 0x20][0];
+    // Send the modified bytes to the controller
+    VFD_flush();
+}
 
-        #if VFD_COLON_SYMBOL_BIT > 8
-        // Set optional colon symbol (if its bit number is > 8, starting from 1)
-        if (colon_symbol && ((grid_cursor == 3) || (grid_cursor == 5))) {
-            // Add the symbol on the MSB part of the byte
-            chrset |= 1 << (VFD_COLON_SYMBOL_BIT - 9);
-        }
-        #endif
 
-        #if ENABLE_ICON_BUFFER == 1
-        VFD_command(chrset | iconDisplayBuffer[memory_addr + 1], false);
-        #else
-        VFD_command(chrset, false);
-        #endif
+/**
+ * @brief Write a fixed-point number without floating-point code (If VARIANT_2 is defined in global.h).
+ *      The decimal point is lit only if the display has a segment between
+ *      the 2 concerned grids (see VFD_DP_MAP).
+ * @param value Scaled integer: the displayed number is value / 10^frac_digits.
+ *      Ex: VFD_writeFixed(1205, 2, 5); displays " 12.05".
+ * @param frac_digits Number of digits after the point (0..9).
+ * @param width Number of characters, the minus sign included (the point doesn't use a character).
+ *      Value range 1..VFD_DISPLAYABLE_DIGITS.
+ * @see VFD_formatFixed() for the padding and the overflow.
+ */
+void VFD_writeFixed(int32_t value, uint8_t frac_digits, uint8_t width)
+{
+    char     string[VFD_DISPLAYABLE_DIGITS + 1];
+    uint8_t  point_grid = 0;
+    uint16_t point      = 0;
 
-        grid_cursor++;
-        string++;
+    if (width > VFD_DISPLAYABLE_DIGITS)
+        width = VFD_DISPLAYABLE_DIGITS;
+
+    frac_digits = VFD_formatFixed(string, value, frac_digits, width);
+
+    if (frac_digits) {
+        // Grid of the digit before the point
+        uint8_t digit_grid = grid_cursor + width - frac_digits - 1;
+        for (uint8_t i = 0; i < sizeof(VFD_DP_MAP) / sizeof(VFD_DP_MAP[0]); i++) {
+            if (pgm_read_byte(&VFD_DP_MAP[i][0]) == digit_grid) {
+                point_grid = pgm_read_byte(&VFD_DP_MAP[i][1]);
+                point      = 1 << (pgm_read_byte(&VFD_DP_MAP[i][2]) - 1);
+            }
+        }
     }
 
-    // Signal the driver that the data transmission is over
-    VFD_CSSignal();
+    for (uint8_t index = 0; index < width; index++) {
+        uint16_t glyph = VFD_fontGlyph(string[index]);
+        if (grid_cursor == point_grid)
+            glyph |= point;
+        placeGlyph(glyph);
+    }
+
+    // Send the modified bytes to the controller
+    VFD_flush();
 }
 
 
+/**
+ * @brief Render 1 character at a grid (If VARIANT_2 is defined in global.h);
+ *      used by VFD_writeCharAt() and PT6312Display::writeCharAt().
+ * @param position See VFD_writeCharAt().
+ * @param character Character present in the font.
+ * @param mask Segments of the character (all but the colon symbol, see VFD_writeBytesAt()).
+ * @param value New state of these segments.
+ * @return Address of the 1st byte to modify, VFD_RENDER_NONE if the position is invalid.
+ */
+uint8_t VFD_renderCharAt(uint8_t position, char character, uint16_t &mask, uint16_t &value)
+{
+    if ((position == 0) || (position > VFD_RENDER_MAX_BYTES / PT6312_BYTES_PER_GRID))
+        return VFD_RENDER_NONE;
+
+    mask  = ~(1 << (VFD_COLON_SYMBOL_BIT - 1));
+    value = VFD_fontGlyph(character);
+    return (position * PT6312_BYTES_PER_GRID) - PT6312_BYTES_PER_GRID;
+}
+
+
+/**
+ * @brief Write 1 character without rewriting the line (If VARIANT_2 is defined in global.h).
+ *      Only the segments of the character are modified: the other grids and
+ *      the colon symbol are preserved; only the modified bytes are sent.
+ *      The grid cursor is not modified.
+ * @param position Character from the left of the display, whatever the grid cursor
+ *      (1 grid = 1 character, i.e. the grid number): value range 1..VFD_GRIDS.
+ *      Other positions are ignored.
+ * @param character Character present in the font.
+ * @see VFD_writeBytesAt()
+ */
+void VFD_writeCharAt(uint8_t position, char character)
+{
+    uint16_t mask = 0, value = 0;
+    uint8_t  address = VFD_renderCharAt(position, character, mask, value);
+
+    #if ENABLE_ICON_BUFFER == 1
+    if (address < PT6312_DISPLAY_MEM)
+        value |= (uint8_t)iconDisplayBuffer[address] | ((uint8_t)iconDisplayBuffer[address + 1] << 8);
+    #endif
+    VFD_writeBytesAt(address, mask, value);
+}
+
+
+/**
+ * Frames of the spinning circle (see VFD_playFrame()), on 2 bytes (0: lsb, 1: msb)
+ * Left shifts notes from segment number to bit number:
+ * msb: segment number -8 -1
+ * lsb: segment number -1
+ * Segments successively displayed with 100% of the duty cycle of 1 frame:
+ * 4, 1, 12, 13, 16, 5
+ * The 3 segments that precede the main displayed segment are fading more and more pronounced
+ * (1/2, 1/5, 1/12 duty cycles).
+ */
+static const uint8_t SPINNER_FRAMES[] PROGMEM = {
+    6, 70, 2,
+    VFD_ANIM_LAST_ELEMENT(0, 1, 1 << (4 - 1)),          // segment 4 (first)
+
+    VFD_ANIM_ELEMENT(0, 1, 1 << (1 - 1)),               // segment 1 (second)
+    VFD_ANIM_LAST_ELEMENT(0, 2, 1 << (4 - 1)),
+
+    VFD_ANIM_ELEMENT(1, 1, 1 << (12 - 8 - 1)),          // segment 12 (third)
+    VFD_ANIM_ELEMENT(0, 2, 1 << (1 - 1)),
+    VFD_ANIM_LAST_ELEMENT(0, 5, 1 << (4 - 1)),
+
+    VFD_ANIM_ELEMENT(1, 1, 1 << (13 - 8 - 1)),          // segment 13 (fourth)
+    VFD_ANIM_ELEMENT(1, 2, 1 << (12 - 8 - 1)),
+    VFD_ANIM_ELEMENT(0, 5, 1 << (1 - 1)),
+    VFD_ANIM_LAST_ELEMENT(0, 12, 1 << (4 - 1)),
+
+    VFD_ANIM_ELEMENT(1, 1, 1 << (16 - 8 - 1)),          // segment 16 (fifth)
+    VFD_ANIM_ELEMENT(1, 2, 1 << (13 - 8 - 1)),
+    VFD_ANIM_ELEMENT(1, 5, 1 << (12 - 8 - 1)),
+    VFD_ANIM_LAST_ELEMENT(0, 12, 1 << (1 - 1)),
+
+    VFD_ANIM_ELEMENT(0, 1, 1 << (5 - 1)),               // segment 5 (sixth)
+    VFD_ANIM_ELEMENT(1, 2, 1 << (16 - 8 - 1)),
+    VFD_ANIM_ELEMENT(1, 5, 1 << (13 - 8 - 1)),
+    VFD_ANIM_LAST_ELEMENT(1, 12, 1 << (12 - 8 - 1)),
+};
+
+
 /**
  * @brief Animation for a busy spinning circle that uses 2 bytes (full grid).
  * @param position Grid number where the animation frames must be displayed.
@@ -108,101 +259,18 @@ void VFD_writeString(const char *string, bool colon_symbol)
  *      Ex: For 5th main segment:
  *          16, 13, 12 are displayed, from the most marked to the darkest;
  *          the others are not displayed (1, 4).
+ *      The frames are described in SPINNER_FRAMES and played by VFD_playFrame().
  * @note grid_cursor global variable is incremented and kept valid by ths function.
  * @see VFD_busyWrapper()
  */
 void VFD_busySpinningCircle(uint8_t position, uint8_t& frame_number, uint8_t& loop_number)
 {
-    uint8_t msb = 0, lsb = 0;
-    // Init duty cycles divisors
-    uint8_t seg2_duty_cycle = 2, seg3_duty_cycle = 5, seg4_duty_cycle = 12;
-
-    // Compute duty cycles triggers
-    seg2_duty_cycle = loop_number % seg2_duty_cycle; // 1/2
-    seg3_duty_cycle = loop_number % seg3_duty_cycle; // 1/5
-    seg4_duty_cycle = loop_number % seg4_duty_cycle; // 1/12
-
-    // Left shifts notes from segment number to bit number:
-    // msb: segment number -8 -1
-    // lsb: segment number -1
-    // Segments successively displayed with 100% of the duty cycle of 1 frame:
-    // 4, 5, 16, 13, 12, 1
-    // The 3 segments that precede the main displayed segment are fading more and more pronounced.
-    if (frame_number == 1) {
-        lsb = 1 << (4 - 1);           // segment 4 (first)
-    }else if (frame_number == 2) {
-        lsb = 1 << (1 - 1);           // segment 1 (second)
-        if (seg2_duty_cycle == 0) {
-            lsb |= 1 << (4 - 1);      // segment 4
-        }
-    }else if (frame_number == 3) {
-        msb = 1 << (12 - 8 - 1);      // segment 12 (third)
-        if (seg2_duty_cycle == 0) {
-            lsb = 1 << (1 - 1);       // segment 1
-        }
-        if (seg3_duty_cycle == 0) {
-            lsb |= 1 << (4 - 1);      // segment 4
-        }
-    }else if (frame_number == 4) {
-        msb = 1 << (13 - 8 - 1);      // segment 13 (fourth)
-        if (seg2_duty_cycle == 0) {
-            msb |= 1 << (12 - 8 - 1); // segment 12
-        }
-        if (seg3_duty_cycle == 0) {
-            lsb = 1 << (1 - 1);       // segment 1
-        }
-        if (seg4_duty_cycle == 0) {
-            lsb |= 1 << (4 - 1);      // segment 4
-        }
-    }else if (frame_number == 5) {
-        msb = 1 << (16 - 8 - 1);      // segment 16 (fifth)
-        if (seg2_duty_cycle == 0) {
-            msb |= 1 << (13 - 8 - 1); // segment 13
-        }
-        if (seg3_duty_cycle == 0) {
-            msb |= 1 << (12 - 8 - 1); // segment 12
-        }
-        if (seg4_duty_cycle == 0) {
-            lsb |= 1 << (1 - 1);      // segment 1
-        }
-    }else if (frame_number == 6) {
-        lsb = 1 << (5 - 1);           // segment 5 (sixth)
-        if (seg2_duty_cycle == 0) {
-            msb |= 1 << (16 - 8 - 1); // segment 16
-        }
-        if (seg3_duty_cycle == 0) {
-            msb = 1 << (13 - 8 - 1); // segment 13
-        }
-        if (seg4_duty_cycle == 0) {
-            msb |= 1 << (12 - 8 - 1); // segment 12
-        }
-    }
-
-    loop_number++;
-    if (loop_number == 70) {
-        if (frame_number == 6) {
-            frame_number = 0;
-        }
-        frame_number++;
-        loop_number = 0;
-    }
-
     VFD_setGridCursor(position);
-    #if ENABLE_ICON_BUFFER == 1
-    uint8_t address = convertGridToMemoryAddress(position);
-    VFD_command(lsb | iconDisplayBuffer[address], false);
-    VFD_command(msb | iconDisplayBuffer[address+1], true);
-    #else
-    VFD_command(lsb, false);
-    VFD_command(msb, true);
-    #endif
+    uint8_t address = (grid_cursor * PT6312_BYTES_PER_GRID) - PT6312_BYTES_PER_GRID;
+    VFD_playFrame(SPINNER_FRAMES, address, frame_number, loop_number);
 
     // Sync cursor
     grid_cursor++;
-
-    // Reset/Update display
-    // => Don't know why but it appears to be mandatory to avoid forever black screen... (?)
-    VFD_resetDisplay();
 }
 
 #endif
@@ -39,18 +39,61 @@
 //#define VFD_DATA_PIN            PB2
 #define VFD_DATA_PIN            4     // Porta usada para sinais de dados.
 #define VFD_DATA_R_ONLY_PORT    PIND
+// Transport: select one backend
+// Software bit-bang on the pins above (default)
+#define VFD_TRANSPORT_BITBANG
+// Hardware SPI of the ATmega: SCLK on SCK, DATA on MOSI with MISO tied to it.
+// SS is configured as an output (it can be used for CS).
+//#define VFD_TRANSPORT_SPI
+// USI three-wire mode of the ATtiny: SCLK on USCK (PB2), DATA on DO (PB1) with DI (PB0) tied to it.
+//#define VFD_TRANSPORT_USI
+// Host build (Linux, without Arduino/AVR): bit-bang on recorded pins (see host/host_pins.h)
+#if !defined(ARDUINO) && !defined(__AVR__)
+#define VFD_TRANSPORT_HOST
+#endif
+#define VFD_SPI_SS_DDR          DDRB
+#define VFD_SPI_SS_PIN          2     // PB2 on ATmega328
+#define VFD_SPI_CLOCK_DIV       16    // F_CPU / 16: 1MHz at 16MHz (4, 16, 64 or 128)
 // VFD Display features
 #define VFD_GRIDS               5 // Number of grids
 #define VFD_DISPLAYABLE_DIGITS  7 // Number of characters that can be displayed simultaneously
+#define VFD_SCROLL_START_DELAY  1000 // In milliseconds, pause on the first window
 #define VFD_SCROLL_DELAY        400 // In milliseconds
+#define VFD_SCROLL_END_DELAY    2000 // In milliseconds, pause at the end
 #define VFD_BUSY_DELAY          2.35 // In milliseconds
+#define VFD_SPINNER_PERIOD_US   2380 // In microseconds, 420 refreshes per second (see VFD_spinnerRefresh())
+#define VFD_GRAYSCALE_PERIOD_US 1000 // In microseconds, period of VFD_grayscaleRefresh() (cycle of 2^VFD_GRAY_BITS - 1 periods)
+#define VFD_FADE_PERIOD_MS      2    // In milliseconds, period of VFD_fadeRefresh()
+#define VFD_FADE_STEPS          4    // Fade levels per brightness step, dithered by VFD_fadeRefresh(); power of 2
+#define VFD_KEY_POLL_PERIOD_MS  10   // In milliseconds, period of VFD_keyService()
+#define VFD_KEY_DEBOUNCE_POLLS  3    // Consecutive polls with the same keys before a change is accepted
+#define VFD_KEY_LONG_PRESS_MS   800  // In milliseconds, hold time before a long press event
+#define VFD_KEY_REPEAT_MS       200  // In milliseconds, period of the repeat events after a long press
 // Library options
 #define ENABLE_ICON_BUFFER      0 // Enable functions and extra buffer to display icons (except spinning circle)
+#ifndef ENABLE_DOUBLE_BUFFER
+#define ENABLE_DOUBLE_BUFFER    0 // Frames are drawn in a back buffer and displayed by VFD_present()
+#endif
+#ifndef ENABLE_GRAYSCALE
+#define ENABLE_GRAYSCALE        0 // Intensity levels per segment, rendered by VFD_grayscaleRefresh() (see VFD_setSegmentLevel())
+#endif
+#define VFD_GRAY_BITS           2 // Bit-planes of the levels: 2^VFD_GRAY_BITS levels (off included)
+#ifndef ENABLE_ASYNC_TX
+#define ENABLE_ASYNC_TX         0 // Queue the transmissions, sent by a timer interrupt (see VFD_txService())
+#endif
+#define VFD_TX_QUEUE_SIZE       32 // Tokens (bytes & strobe edges) in the queue; power of 2
+#define VFD_KEY_QUEUE_SIZE      8  // Key events in the queue (see VFD_pollKeyEvent()); power of 2
+#ifndef VFD_RESYNC_INTERVAL
+#define VFD_RESYNC_INTERVAL     0  // Flushes between 2 resends of the display control; 0: only after a mode setting/reset
+#endif
 
 // Fonts (files are included in ET16312N.cpp)
+// The variant can also be given on the command line (-DVFD_VARIANT_2)
+#if !defined(VFD_VARIANT_1) && !defined(VFD_VARIANT_2)
 // "2 chars per grid display"
 #define VFD_VARIANT_1
 // "1 char per grid display"
 //#define VFD_VARIANT_2
+#endif
 
 #endif // ET16312N_GLOBAL_H
@@ -0,0 +1,289 @@
+/* PT6312 is an Arduino library for the PT6312 family of Vacuum Fluorescent Display controllers.
+ * Copyright (C) 2022 Ysard - <ysard@users.noreply.github.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <global.h>
+
+#if defined(VFD_TRANSPORT_HOST)
+
+#include "host/PT6312_emulator.h"
+
+PT6312Emulator *PT6312Emulator::attached[PT6312_EMU_MAX_ATTACHED];
+
+
+/**
+ * @param stb_line STB line of the controller: VFD_HOST_STB (default), VFD_HOST_STB2, etc.
+ */
+PT6312Emulator::PT6312Emulator(uint8_t stb_line) : stb_line(stb_line)
+{
+    reset();
+}
+
+
+/**
+ * @brief Listen to the recorded pins; up to PT6312_EMU_MAX_ATTACHED emulators
+ *      (with different STB lines) can be attached at a time.
+ */
+void PT6312Emulator::attach()
+{
+    uint8_t i;
+    for (i = 0; i < PT6312_EMU_MAX_ATTACHED; i++) {
+        if (attached[i] == this)
+            return;
+    }
+    for (i = 0; i < PT6312_EMU_MAX_ATTACHED; i++) {
+        if (attached[i] == nullptr) {
+            attached[i] = this;
+            break;
+        }
+    }
+    vfd_host_bus.listener = &PT6312Emulator::onLines;
+}
+
+
+void PT6312Emulator::detach()
+{
+    for (uint8_t i = 0; i < PT6312_EMU_MAX_ATTACHED; i++) {
+        if (attached[i] == this)
+            attached[i] = nullptr;
+    }
+}
+
+
+/**
+ * @brief Power-on state: blank memory, display off, default mode (7 grids, 15 segments).
+ *      Injected keys and switches are released.
+ */
+void PT6312Emulator::reset()
+{
+    for (uint8_t i = 0; i < PT6312_EMU_DISPLAY_RAM; i++)
+        display_ram[i] = 0;
+    for (uint8_t i = 0; i < PT6312_KEY_MEM; i++)
+        key_ram[i] = 0;
+
+    switches        = 0;
+    leds            = PT6312_LED_MSK;
+    display_mode    = PT6312_MODE_SET_CMD | PT6312_GR7_SEG15;
+    data_setting    = PT6312_DATA_SET_CMD | PT6312_MODE_NORM | PT6312_ADDR_INC | PT6312_DATA_WR;
+    display_control = PT6312_DSP_CTRL_CMD | PT6312_DSP_OFF | PT6312_BRT0;
+    latched_control = 0;
+    address         = 0;
+
+    shift_reg  = 0;
+    bit_count  = 0;
+    first_byte = true;
+    read_index = 0;
+
+    resetCounters();
+}
+
+
+void PT6312Emulator::resetCounters()
+{
+    windows    = 0;
+    commands   = 0;
+    data_bytes = 0;
+    read_bytes = 0;
+}
+
+
+/**
+ * @brief Inject the key matrix in the format returned by VFD_getKeys().
+ * @param raw_keys 6 samples of 4 bits each in the 3 least significant bytes.
+ */
+void PT6312Emulator::setKeys(uint32_t raw_keys)
+{
+    key_ram[0] = raw_keys >> 16;
+    key_ram[1] = raw_keys >> 8;
+    key_ram[2] = raw_keys;
+}
+
+
+void PT6312Emulator::setSwitches(uint8_t value)
+{
+    switches = value & PT6312_SW_MSK;
+}
+
+
+/**
+ * @brief Segments of a grid: LSB at the 1st address of the grid, MSB at the 2nd.
+ * @param position Grid number starting from 1.
+ */
+uint16_t PT6312Emulator::grid(uint8_t position) const
+{
+    uint8_t addr = (position * PT6312_BYTES_PER_GRID) - PT6312_BYTES_PER_GRID;
+    if (addr + 1 >= PT6312_EMU_DISPLAY_RAM)
+        return 0;
+    return display_ram[addr] | (display_ram[addr + 1] << 8);
+}
+
+
+bool PT6312Emulator::displayOn() const
+{
+    return display_control & PT6312_DSP_ON;
+}
+
+
+uint8_t PT6312Emulator::brightness() const
+{
+    return display_control & PT6312_BRT_MSK;
+}
+
+
+bool PT6312Emulator::testMode() const
+{
+    return data_setting & PT6312_MODE_TEST;
+}
+
+
+bool PT6312Emulator::fixedAddress() const
+{
+    return data_setting & PT6312_ADDR_FIXED;
+}
+
+
+/**
+ * @brief LEDs that are lit (bit set: LED on), the latch is active low.
+ */
+uint8_t PT6312Emulator::ledsOn() const
+{
+    return ~leds & PT6312_LED_MSK;
+}
+
+
+void PT6312Emulator::onLines(uint8_t previous_lines, uint8_t lines)
+{
+    for (uint8_t i = 0; i < PT6312_EMU_MAX_ATTACHED; i++) {
+        if (attached[i] != nullptr)
+            attached[i]->edge(previous_lines, lines);
+    }
+}
+
+
+/**
+ * @brief Byte shifted out at the given index of a read transmission.
+ */
+uint8_t PT6312Emulator::readData(uint8_t index) const
+{
+    if ((data_setting & 0x03) == PT6312_SW_RD)
+        return (index == 0) ? switches : 0;
+    return (index < PT6312_KEY_MEM) ? key_ram[index] : 0;
+}
+
+
+void PT6312Emulator::edge(uint8_t previous_lines, uint8_t lines)
+{
+    uint8_t changed = previous_lines ^ lines;
+
+    if (changed & stb_line) {
+        if (lines & stb_line) {
+            // End of transmission: an incomplete byte is discarded, DOUT is released
+            VFD_hostDriveData(true);
+        } else {
+            // Start of transmission: the 1st byte is a command
+            windows++;
+            first_byte = true;
+            bit_count  = 0;
+            shift_reg  = 0;
+            read_index = 0;
+        }
+        return;
+    }
+
+    if ((lines & stb_line) || !(changed & VFD_HOST_CLK))
+        return;
+
+    bool reading = !first_byte && (data_setting & 0x02);
+
+    if (reading) {
+        // Read modes: data is shifted out LSB first on falling edges
+        if (!(lines & VFD_HOST_CLK)) {
+            VFD_hostDriveData((readData(read_index) >> bit_count) & 1);
+        } else if (++bit_count == 8) {
+            bit_count = 0;
+            read_index++;
+            read_bytes++;
+        }
+        return;
+    }
+
+    // Write: DIN is sampled LSB first on rising edges
+    if (lines & VFD_HOST_CLK) {
+        if (lines & VFD_HOST_DIN)
+            shift_reg |= 1 << bit_count;
+        if (++bit_count == 8) {
+            processByte(shift_reg);
+            bit_count = 0;
+            shift_reg = 0;
+        }
+    }
+}
+
+
+void PT6312Emulator::processByte(uint8_t value)
+{
+    if (first_byte) {
+        first_byte = false;
+        commands++;
+
+        switch (value & 0xC0) {
+        case PT6312_MODE_SET_CMD:
+            // The display is turned off until the next display control command
+            display_mode     = value;
+            display_control &= ~PT6312_DSP_ON;
+            latched_control  = 0;
+            break;
+        case PT6312_DATA_SET_CMD:
+            data_setting = value;
+            if (latched_control) {
+                display_control = latched_control;
+                latched_control = 0;
+            }
+            break;
+        case PT6312_DSP_CTRL_CMD:
+            if (!(display_control & PT6312_DSP_ON) && (value & PT6312_DSP_ON)) {
+                // Turned on only by the next data setting command
+                latched_control = value;
+            } else {
+                // Brightness change of a lit display, or display turned off
+                display_control = value;
+                latched_control = 0;
+            }
+            break;
+        case PT6312_ADDR_SET_CMD:
+            address = value & PT6312_ADDR_MSK;
+            break;
+        }
+        return;
+    }
+
+    data_bytes++;
+    switch (data_setting & 0x03) {
+    case PT6312_DATA_WR:
+        if (address < PT6312_EMU_DISPLAY_RAM)
+            display_ram[address] = value;
+        if (!(data_setting & PT6312_ADDR_FIXED)) {
+            address++;
+            if (address >= PT6312_EMU_DISPLAY_RAM)
+                address = 0;
+        }
+        break;
+    case PT6312_LED_WR:
+        leds = value & PT6312_LED_MSK;
+        break;
+    }
+}
+
+#endif
@@ -0,0 +1,96 @@
+/* PT6312 is an Arduino library for the PT6312 family of Vacuum Fluorescent Display controllers.
+ * Copyright (C) 2022 Ysard - <ysard@users.noreply.github.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Model of the PT6312 for the host build (VFD_TRANSPORT_HOST).
+ * It decodes the serial stream emitted on the recorded pins (see host_pins.h):
+ * mode setting, data setting (write/LED/key/switch, increment/fixed address,
+ * normal/test mode), address setting and display control commands.
+ * Keys and switches can be injected; they are shifted out on DOUT when read.
+ *
+ * Usage:
+ *      PT6312Emulator emulator;
+ *      emulator.attach();
+ *      VFD_initialize();
+ *      VFD_writeString("1234", false);
+ *      emulator.grid(1);
+ *
+ * Controllers sharing CLK & DIN are modeled with 1 emulator per STB line:
+ *      PT6312Emulator second(VFD_HOST_STB2);
+ */
+#ifndef PT6312_EMULATOR_H
+#define PT6312_EMULATOR_H
+
+#include "PT6312.h"
+
+// Size of the display memory of the controller (addresses 0x00..0x15)
+#define PT6312_EMU_DISPLAY_RAM   22
+// Controllers attached at the same time (1 per STB line)
+#define PT6312_EMU_MAX_ATTACHED  4
+
+struct PT6312Emulator
+{
+    // Controller state
+    uint8_t  display_ram[PT6312_EMU_DISPLAY_RAM];
+    uint8_t  key_ram[PT6312_KEY_MEM];  // Bytes in reading order
+    uint8_t  switches;                 // 4 least significant bits
+    uint8_t  leds;                     // LED latch as received (bit set: LED off)
+    uint8_t  display_mode;             // Last mode setting command
+    uint8_t  data_setting;             // Last data setting command
+    uint8_t  display_control;          // Display control in effect
+    uint8_t  latched_control;          // Display control waiting for a data setting (0: none)
+    uint8_t  address;                  // Address pointer of the display memory
+
+    // Decoded traffic since the last reset()
+    uint32_t windows;                  // Strobe windows (transmissions)
+    uint32_t commands;                 // Command bytes (1st byte of a window)
+    uint32_t data_bytes;               // Data bytes received after a command
+    uint32_t read_bytes;               // Bytes shifted out to the MCU
+
+    PT6312Emulator(uint8_t stb_line = VFD_HOST_STB);
+
+    void attach();
+    void detach();
+    void reset();
+    void resetCounters();
+
+    // Inputs
+    void setKeys(uint32_t raw_keys);
+    void setSwitches(uint8_t value);
+
+    // Outputs
+    uint16_t grid(uint8_t position) const;
+    bool     displayOn() const;
+    uint8_t  brightness() const;
+    bool     testMode() const;
+    bool     fixedAddress() const;
+    uint8_t  ledsOn() const;
+
+private:
+    uint8_t stb_line;                  // STB line of this controller
+    uint8_t shift_reg;
+    uint8_t bit_count;
+    bool    first_byte;
+    uint8_t read_index;
+
+    static PT6312Emulator *attached[PT6312_EMU_MAX_ATTACHED];
+    static void onLines(uint8_t previous_lines, uint8_t lines);
+    void edge(uint8_t previous_lines, uint8_t lines);
+    void processByte(uint8_t value);
+    uint8_t readData(uint8_t index) const;
+};
+
+#endif // PT6312_EMULATOR_H
@@ -0,0 +1,47 @@
+/* PT6312 is an Arduino library for the PT6312 family of Vacuum Fluorescent Display controllers.
+ * Copyright (C) 2022 Ysard - <ysard@users.noreply.github.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Host build (VFD_TRANSPORT_HOST): avr/pgmspace.h replacement.
+ * There is a single address space: the tables stay in memory and are read with plain loads.
+ */
+#ifndef PT6312_HOST_PGMSPACE_H
+#define PT6312_HOST_PGMSPACE_H
+
+#include <stdint.h>
+#include <string.h>
+
+#define PROGMEM
+
+inline uint8_t pgm_read_byte(const void *address)
+{
+    return *(const uint8_t *)address;
+}
+
+inline uint16_t pgm_read_word(const void *address)
+{
+    // Unaligned & little endian like on the AVR
+    const uint8_t *bytes = (const uint8_t *)address;
+    return bytes[0] | (bytes[1] << 8);
+}
+
+inline uint32_t pgm_read_dword(const void *address)
+{
+    const uint8_t *bytes = (const uint8_t *)address;
+    return bytes[0] | (bytes[1] << 8) | ((uint32_t)bytes[2] << 16) | ((uint32_t)bytes[3] << 24);
+}
+
+#endif // PT6312_HOST_PGMSPACE_H
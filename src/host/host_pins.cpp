@@ -0,0 +1,88 @@
+/* PT6312 is an Arduino library for the PT6312 family of Vacuum Fluorescent Display controllers.
+ * Copyright (C) 2022 Ysard - <ysard@users.noreply.github.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <global.h>
+
+#if defined(VFD_TRANSPORT_HOST)
+
+#include "host/host_pins.h"
+
+VFD_HostBus vfd_host_bus = {
+    VFD_HOST_STB_LINES | VFD_HOST_CLK | VFD_HOST_DIN, // Idle lines
+    true,                                             // DATA is an output
+    true,                                             // Released DATA line is pulled up
+    0, 0, 0, 0, 0, false, {}, nullptr
+};
+
+
+/**
+ * @brief Reset the counters, the modeled clock and the trace.
+ *      The levels of the lines and the listener are kept.
+ */
+void VFD_hostReset(void)
+{
+    vfd_host_bus.time_ns  = 0;
+    vfd_host_bus.sleep_ns = 0;
+    vfd_host_bus.edges    = 0;
+    vfd_host_bus.clocks   = 0;
+    vfd_host_bus.strobes  = 0;
+    vfd_host_bus.trace.clear();
+}
+
+
+/**
+ * @brief Set the level of a line; record the transition and notify the listener.
+ * @param line VFD_HOST_STB (or VFD_HOST_STB2..4), VFD_HOST_CLK or VFD_HOST_DIN.
+ * @param level Level of the line.
+ */
+void VFD_hostSetLine(uint8_t line, bool level)
+{
+    uint8_t previous_lines = vfd_host_bus.lines;
+    uint8_t lines          = (level) ? (previous_lines | line) : (previous_lines & ~line);
+
+    if (lines == previous_lines)
+        return;
+
+    vfd_host_bus.lines = lines;
+    vfd_host_bus.edges++;
+    if ((line == VFD_HOST_CLK) && level)
+        vfd_host_bus.clocks++;
+    if ((line & VFD_HOST_STB_LINES) && !level)
+        vfd_host_bus.strobes++;
+
+    if (vfd_host_bus.trace_enabled) {
+        vfd_host_bus.trace.push_back({vfd_host_bus.time_ns, lines});
+    }
+    if (vfd_host_bus.listener != nullptr) {
+        vfd_host_bus.listener(previous_lines, lines);
+    }
+}
+
+
+/**
+ * @brief Level driven by the controller on the DATA line.
+ *      It is visible on the line only when the MCU has released it.
+ * @param level false to pull the line down, true to release it (pull-up).
+ */
+void VFD_hostDriveData(bool level)
+{
+    vfd_host_bus.dout = level;
+    if (!vfd_host_bus.data_output) {
+        VFD_hostSetLine(VFD_HOST_DIN, level);
+    }
+}
+
+#endif
@@ -0,0 +1,117 @@
+/* PT6312 is an Arduino library for the PT6312 family of Vacuum Fluorescent Display controllers.
+ * Copyright (C) 2022 Ysard - <ysard@users.noreply.github.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Host build (VFD_TRANSPORT_HOST): the library runs on a PC against recorded pins.
+ * Every transition of the STB/CLK/DIN lines is counted, optionally stored in a trace,
+ * and forwarded to a listener (i.e. a model of the controller).
+ * _delay_us() and _delay_ms() don't wait: they advance a modeled clock.
+ */
+#ifndef PT6312_HOST_PINS_H
+#define PT6312_HOST_PINS_H
+
+#include <stdint.h>
+#include <vector>
+
+// Lines of the bus (bit masks of VFD_HostBus::lines)
+#define VFD_HOST_STB    0x01
+#define VFD_HOST_CLK    0x02
+#define VFD_HOST_DIN    0x04
+// Additional STB lines: controllers sharing CLK & DIN (see VFD_HostPinsOn)
+#define VFD_HOST_STB2   0x08
+#define VFD_HOST_STB3   0x10
+#define VFD_HOST_STB4   0x20
+#define VFD_HOST_STB_LINES  (VFD_HOST_STB | VFD_HOST_STB2 | VFD_HOST_STB3 | VFD_HOST_STB4)
+
+struct VFD_HostEdge
+{
+    uint64_t time_ns; // Modeled time of the transition
+    uint8_t  lines;   // Levels of the lines after the transition
+};
+
+struct VFD_HostBus
+{
+    uint8_t  lines;          // Current levels of the lines
+    bool     data_output;    // Direction of the DATA pin on the MCU side
+    bool     dout;           // Level driven by the controller on DATA (open drain + pull-up)
+    uint64_t time_ns;        // Modeled time spent in _delay_us() (bus timings)
+    uint64_t sleep_ns;       // Modeled time spent in _delay_ms() (application pauses)
+    uint32_t edges;          // Number of transitions since the last VFD_hostReset()
+    uint32_t clocks;         // Number of SCLK rising edges since the last VFD_hostReset()
+    uint32_t strobes;        // Number of transmissions (falling edges of the STB lines) since the last VFD_hostReset()
+    bool     trace_enabled;  // Store the transitions in trace
+    std::vector<VFD_HostEdge> trace;
+    // Called after each transition
+    void     (*listener)(uint8_t previous_lines, uint8_t lines);
+};
+
+extern VFD_HostBus vfd_host_bus;
+
+void VFD_hostReset(void);
+void VFD_hostSetLine(uint8_t line, bool level);
+void VFD_hostDriveData(bool level);
+
+/**
+ * Delays of avr-libc: advance the modeled clock
+ */
+inline void _delay_us(double us)
+{
+    vfd_host_bus.time_ns += (uint64_t)(us * 1000);
+}
+
+inline void _delay_ms(double ms)
+{
+    vfd_host_bus.sleep_ns += (uint64_t)(ms * 1000000);
+}
+
+/**
+ * Pins policy of the host build (see transport.h)
+ * @param Stb STB line of the controller (VFD_HOST_STB, VFD_HOST_STB2, etc.)
+ */
+template <uint8_t Stb>
+struct VFD_HostPinsOn
+{
+    static inline void init()
+    {
+        vfd_host_bus.data_output = true;
+        VFD_hostSetLine(Stb, true);
+        VFD_hostSetLine(VFD_HOST_CLK, true);
+    }
+    static inline void csLow()      { VFD_hostSetLine(Stb, false); }
+    static inline void csHigh()     { VFD_hostSetLine(Stb, true); }
+    static inline bool csIsHigh()   { return vfd_host_bus.lines & Stb; }
+    static inline void clkLow()     { VFD_hostSetLine(VFD_HOST_CLK, false); }
+    static inline void clkHigh()    { VFD_hostSetLine(VFD_HOST_CLK, true); }
+    static inline void dataLow()    { if (vfd_host_bus.data_output) VFD_hostSetLine(VFD_HOST_DIN, false); }
+    static inline void dataHigh()   { if (vfd_host_bus.data_output) VFD_hostSetLine(VFD_HOST_DIN, true); }
+    static inline bool dataIsHigh() { return vfd_host_bus.lines & VFD_HOST_DIN; }
+    static inline void dataInput()
+    {
+        // The line is now driven by the controller (pulled up when released)
+        vfd_host_bus.data_output = false;
+        VFD_hostSetLine(VFD_HOST_DIN, vfd_host_bus.dout);
+    }
+    static inline void dataOutput()
+    {
+        // The pull-up was enabled: the pin drives a HIGH level
+        vfd_host_bus.data_output = true;
+        VFD_hostSetLine(VFD_HOST_DIN, true);
+    }
+};
+
+typedef VFD_HostPinsOn<VFD_HOST_STB> VFD_HostPins;
+
+#endif // PT6312_HOST_PINS_H
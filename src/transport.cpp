@@ -0,0 +1,131 @@
+/* PT6312 is an Arduino library for the PT6312 family of Vacuum Fluorescent Display controllers.
+ * Copyright (C) 2022 Ysard - <ysard@users.noreply.github.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* C API of the transport: thin wrappers around PT6312Driver<VFD_Transport>.
+ * See transport.h for the available backends.
+ */
+#include "PT6312.h"
+
+
+/**
+ * @brief Configure the pins (and the peripheral) used to communicate with the controller.
+ *      CS and SCLK are HIGH when idle.
+ */
+void VFD_transportInit(void)
+{
+    VFD_Driver::init();
+}
+
+
+/**
+ * @brief Release the DATA line so that the controller can drive it.
+ *      Must be called after a read command (the transmission stays open).
+ * @see VFD_transportWriteMode()
+ */
+void VFD_transportReadMode(void)
+{
+    VFD_Driver::readMode();
+}
+
+
+/**
+ * @brief Take back the DATA line after reading data from the controller.
+ * @see VFD_transportReadMode()
+ */
+void VFD_transportWriteMode(void)
+{
+    VFD_Driver::writeMode();
+}
+
+
+/**
+ * @brief Send a byte in a write command to the controller
+ * @param value Byte to send.
+ * @param cmd (Optional)
+ *      If True, the CS/Strobe line is asserted to HIGH (end of transmission)
+ *      after the byte has been sent.
+ *      Default: false
+ * @note The CS/Strobe line is pulled to LOW only at the beginning of a transmission;
+ *      the following bytes of the same transmission are sent back-to-back.
+ * @warning Display data sent with this function bypasses the shadow framebuffer;
+ *      use VFD_invalidate() to resynchronize it.
+ */
+void VFD_command(uint8_t value, bool cmd)
+{
+    VFD_Driver::command(value, cmd);
+}
+
+
+/**
+ * @brief Obtain a byte from the controller (i.e get keys & switches status)
+ *      The DATA line must have been released with VFD_transportReadMode().
+ * @see VFD_getSwitches(), VFD_getKeys(), VFD_getKeyPressed().
+ * @return Byte of data
+ */
+uint8_t VFD_readByte(void)
+{
+    return VFD_Driver::readByte();
+}
+
+
+/**
+ * @brief Write consecutive bytes in the controller memory in 1 transmission.
+ *      The address setting command and the whole payload are sent in the same
+ *      strobe window; the address is auto-incremented by the controller.
+ * @param address Address of the first byte. Value range 0x00..0x15 (22 addresses).
+ * @param data Bytes to write.
+ * @param len Number of bytes to write.
+ * @warning This function bypasses the shadow framebuffer;
+ *      use VFD_setBufferByte() and VFD_flush() instead for display data.
+ */
+void VFD_writeBurst(uint8_t address, const uint8_t *data, uint8_t len)
+{
+    VFD_Driver::writeBurst(address, data, len);
+}
+
+
+/**
+ * @brief Wait until all the queued transmissions have been sent to the controller.
+ *      Without ENABLE_ASYNC_TX, transmissions are synchronous and this function returns immediately.
+ * @see VFD_txService()
+ */
+void VFD_waitIdle(void)
+{
+    #if ENABLE_ASYNC_TX == 1
+    VFD_Transport::waitIdle();
+    #endif
+}
+
+
+/**
+ * @brief Send the next half-bit (or strobe edge) of the queued transmissions.
+ *      Must be called from a timer compare interrupt when ENABLE_ASYNC_TX is set;
+ *      the period of the interrupt is the half period of SCLK.
+ *      The controller accepts a half period of 0.5us, the limit is the MCU:
+ *      a call costs ~100 cycles with the entry/exit of the interrupt (~6us at 16MHz).
+ *      A period of 20us (50kHz) is a realistic minimum: SCLK at 25kHz, 16 calls
+ *      per byte + 2 per transmission (strobe edges), i.e. ~3 kbytes/s (a frame of
+ *      10 bytes + address: 178 calls, ~3.6ms), ~30% of the CPU while the queue isn't empty.
+ *      Without ENABLE_ASYNC_TX, this function does nothing.
+ * @see VFD_waitIdle()
+ */
+void VFD_txService(void)
+{
+    #if ENABLE_ASYNC_TX == 1
+    VFD_Transport::service();
+    #endif
+}
@@ -0,0 +1,501 @@
+/* PT6312 is an Arduino library for the PT6312 family of Vacuum Fluorescent Display controllers.
+ * Copyright (C) 2022 Ysard - <ysard@users.noreply.github.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Serial transport between the MCU and the controller.
+ * The backend is selected in global.h:
+ *  - VFD_TRANSPORT_BITBANG: software bit-bang on any pins (default),
+ *  - VFD_TRANSPORT_SPI: hardware SPI of the ATmega (LSB first, mode 3),
+ *  - VFD_TRANSPORT_USI: USI three-wire mode of the ATtiny,
+ *  - VFD_TRANSPORT_HOST: bit-bang on recorded pins (host build, see host/host_pins.h).
+ * The CS/Strobe line is always a GPIO driven by the library.
+ * With ENABLE_ASYNC_TX, the bit-bang transport is wrapped in a queue drained
+ * by a timer interrupt (see VFD_AsyncTransport).
+ *
+ * In all cases the data is shifted LSB first; it is set up on the falling edge
+ * of SCLK and sampled on the rising edge (SCLK is HIGH when idle).
+ */
+#ifndef PT6312_TRANSPORT_H
+#define PT6312_TRANSPORT_H
+
+#include "PT6312_driver.h"
+
+/**
+ * Pins policies: static members driving the CS, SCLK and DATA lines.
+ */
+#if !defined(VFD_TRANSPORT_HOST)
+// MCU pins configured in global.h
+struct VFD_AvrPins
+{
+    static inline void init()
+    {
+        _pinMode(VFD_CS_DDR, VFD_CS_PIN, _OUTPUT);
+        _pinMode(VFD_SCLK_DDR, VFD_SCLK_PIN, _OUTPUT);
+        _pinMode(VFD_DATA_DDR, VFD_DATA_PIN, _OUTPUT);
+
+        _digitalWrite(VFD_CS_PORT, VFD_CS_PIN, _HIGH);
+        _digitalWrite(VFD_SCLK_PORT, VFD_SCLK_PIN, _HIGH);
+    }
+    static inline void csLow()      { _digitalWrite(VFD_CS_PORT, VFD_CS_PIN, _LOW); }
+    static inline void csHigh()     { _digitalWrite(VFD_CS_PORT, VFD_CS_PIN, _HIGH); }
+    static inline bool csIsHigh()   { return bit_is_set(VFD_CS_PORT, VFD_CS_PIN); }
+    static inline void clkLow()     { _digitalWrite(VFD_SCLK_PORT, VFD_SCLK_PIN, _LOW); }
+    static inline void clkHigh()    { _digitalWrite(VFD_SCLK_PORT, VFD_SCLK_PIN, _HIGH); }
+    static inline void dataLow()    { _digitalWrite(VFD_DATA_PORT, VFD_DATA_PIN, _LOW); }
+    static inline void dataHigh()   { _digitalWrite(VFD_DATA_PORT, VFD_DATA_PIN, _HIGH); }
+    // DigitalRead (read only) of VFD_DATA_PIN status
+    static inline bool dataIsHigh() { return bit_is_set(VFD_DATA_R_ONLY_PORT, VFD_DATA_PIN); }
+    static inline void dataInput()
+    {
+        // Configure DATA pin input HIGH
+        _pinMode(VFD_DATA_DDR, VFD_DATA_PIN, _INPUT);
+        _digitalWrite(VFD_DATA_PORT, VFD_DATA_PIN, _HIGH);
+    }
+    static inline void dataOutput() { _pinMode(VFD_DATA_DDR, VFD_DATA_PIN, _OUTPUT); }
+};
+
+
+/**
+ * Ports of the MCU for VFD_Pin: DDRx, PORTx and PINx registers
+ */
+#define VFD_DEFINE_PORT(LETTER)                                            \
+    struct VFD_Port##LETTER                                                \
+    {                                                                      \
+        static inline volatile uint8_t &ddr()  { return DDR##LETTER; }     \
+        static inline volatile uint8_t &port() { return PORT##LETTER; }    \
+        static inline volatile uint8_t &pin()  { return PIN##LETTER; }     \
+    };
+#if defined(PORTA)
+VFD_DEFINE_PORT(A)
+#endif
+#if defined(PORTB)
+VFD_DEFINE_PORT(B)
+#endif
+#if defined(PORTC)
+VFD_DEFINE_PORT(C)
+#endif
+#if defined(PORTD)
+VFD_DEFINE_PORT(D)
+#endif
+
+/**
+ * A pin of a port; the registers are constants: accesses compile to sbi/cbi/sbic
+ */
+template <class Port, uint8_t Bit>
+struct VFD_Pin
+{
+    static inline void output()  { Port::ddr() |= (1 << Bit); }
+    static inline void input()   { Port::ddr() &= ~(1 << Bit); }
+    static inline void high()    { Port::port() |= (1 << Bit); }
+    static inline void low()     { Port::port() &= ~(1 << Bit); }
+    // Level set on the output (or pull-up state of an input)
+    static inline bool isHigh()  { return Port::port() & (1 << Bit); }
+    // Level read on the pin
+    static inline bool read()    { return Port::pin() & (1 << Bit); }
+};
+
+/**
+ * Pins policy from 3 VFD_Pin
+ */
+template <class CsPin, class SclkPin, class DataPin>
+struct VFD_GpioPins
+{
+    static inline void init()
+    {
+        CsPin::output();
+        SclkPin::output();
+        DataPin::output();
+
+        CsPin::high();
+        SclkPin::high();
+    }
+    static inline void csLow()      { CsPin::low(); }
+    static inline void csHigh()     { CsPin::high(); }
+    static inline bool csIsHigh()   { return CsPin::isHigh(); }
+    static inline void clkLow()     { SclkPin::low(); }
+    static inline void clkHigh()    { SclkPin::high(); }
+    static inline void dataLow()    { DataPin::low(); }
+    static inline void dataHigh()   { DataPin::high(); }
+    static inline bool dataIsHigh() { return DataPin::read(); }
+    static inline void dataInput()
+    {
+        // Configure DATA pin input HIGH
+        DataPin::input();
+        DataPin::high();
+    }
+    static inline void dataOutput() { DataPin::output(); }
+};
+#endif
+
+
+/**
+ * Software bit-bang transport over a pins policy
+ */
+template <class Pins>
+struct VFD_BitBangTransport
+{
+    static inline void init()     { Pins::init(); }
+    static inline void csLow()    { Pins::csLow(); }
+    static inline void csHigh()   { Pins::csHigh(); }
+    static inline bool csIsHigh() { return Pins::csIsHigh(); }
+
+    static inline void strobeDelay()
+    {
+        _delay_us(1);
+    }
+
+    static inline void write(uint8_t value)
+    {
+        for (uint8_t i = 0; i < 8; i++)
+        {
+            Pins::clkLow();
+
+            if (value & (1 << i)) {
+                Pins::dataHigh();
+            }else{
+                Pins::dataLow();
+            }
+            // wait 500ns
+            _delay_us(0.5);
+            // Data is read at the rising edge
+            Pins::clkHigh();
+            _delay_us(0.5);
+        }
+    }
+
+    static inline uint8_t read()
+    {
+        uint8_t data_in = 0xFF;
+
+        for (uint8_t i = 0; i < 8; i++)
+        {
+            Pins::clkLow();
+            _delay_us(0.5);
+
+            // Data is read at the falling edge
+            if (!Pins::dataIsHigh()) {
+                // Bit is not set: Clear the bit
+                data_in &= ~(1 << i);
+            }
+
+            Pins::clkHigh();
+            _delay_us(0.5);
+        }
+        return data_in;
+    }
+
+    static inline void readMode()
+    {
+        Pins::dataInput();
+        // Here: CS is still LOW, SCLK is still HIGH
+        _delay_us(1);
+    }
+
+    static inline void writeMode()
+    {
+        // Restore DATA pin as OUTPUT
+        Pins::dataOutput();
+    }
+};
+
+
+// Block of code that can't be interrupted (data shared with an interrupt service)
+#if defined(VFD_TRANSPORT_HOST)
+    #define VFD_ATOMIC
+#else
+    #include <util/atomic.h>
+    #define VFD_ATOMIC ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+#endif
+
+#if ENABLE_ASYNC_TX == 1
+#define VFD_TX_ATOMIC VFD_ATOMIC
+#if defined(VFD_TRANSPORT_HOST)
+    // No interrupt on the host: a full queue is drained by the caller
+    #define VFD_TX_INTERRUPTS_ENABLED() false
+#else
+    #define VFD_TX_INTERRUPTS_ENABLED() bit_is_set(SREG, SREG_I)
+#endif
+
+// Tokens of the queue: a byte to shift out, or an edge of the CS/Strobe line
+#define VFD_TX_CS_LOW   0x100
+#define VFD_TX_CS_HIGH  0x200
+
+#if (VFD_TX_QUEUE_SIZE & (VFD_TX_QUEUE_SIZE - 1)) || (VFD_TX_QUEUE_SIZE > 128)
+    #error "VFD_TX_QUEUE_SIZE must be a power of 2 (max 128)"
+#endif
+
+/**
+ * Asynchronous bit-bang transport: writes are stored in a ring buffer
+ * and shifted out by service(), called from a timer compare interrupt
+ * (see VFD_txService()). Each call moves the bus by 1 half-bit
+ * (SCLK falling edge + DATA setup, or SCLK rising edge) or 1 strobe edge;
+ * the period of the interrupt is thus the half period of SCLK.
+ *
+ * csIsHigh() returns the state of the CS/Strobe line once the queue is drained,
+ * so the framing of the driver is unchanged. Reads are synchronous:
+ * readMode() waits for the pending writes (including the read command).
+ */
+template <class Pins>
+struct VFD_AsyncTransport : VFD_BitBangTransport<Pins>
+{
+    static volatile uint16_t queue[VFD_TX_QUEUE_SIZE];
+    static volatile uint8_t  head;      // Next free slot (written by the program)
+    static volatile uint8_t  tail;      // Next token to send (written by the interrupt)
+    static volatile uint8_t  half_bits; // Remaining half-bits of the current byte
+    static uint8_t           shift_reg; // Current byte (interrupt only)
+    static bool              cs_high;   // CS/Strobe state once the queue is drained
+
+    static inline void init()
+    {
+        head      = 0;
+        tail      = 0;
+        half_bits = 0;
+        cs_high   = true;
+        Pins::init();
+    }
+
+    static inline void csLow()
+    {
+        cs_high = false;
+        enqueue(VFD_TX_CS_LOW);
+    }
+
+    static inline void csHigh()
+    {
+        cs_high = true;
+        enqueue(VFD_TX_CS_HIGH);
+    }
+
+    static inline bool csIsHigh()    { return cs_high; }
+
+    // The setup/hold times are given by the period of the interrupt
+    static inline void strobeDelay() {}
+
+    static inline void write(uint8_t value)
+    {
+        enqueue(value);
+    }
+
+    static inline void readMode()
+    {
+        waitIdle();
+        VFD_BitBangTransport<Pins>::readMode();
+    }
+
+    static inline bool idle()
+    {
+        return (head == tail) && (half_bits == 0);
+    }
+
+    static inline void waitIdle()
+    {
+        while (!idle()) {
+            if (!VFD_TX_INTERRUPTS_ENABLED()) {
+                // Called with interrupts disabled (or on the host): drain the queue here
+                service();
+            }
+        }
+    }
+
+    static inline void enqueue(uint16_t token)
+    {
+        uint8_t next;
+        while (true) {
+            VFD_TX_ATOMIC {
+                next = (head + 1) & (VFD_TX_QUEUE_SIZE - 1);
+                if (next != tail) {
+                    queue[head] = token;
+                    head = next;
+                    return;
+                }
+            }
+            // Queue full
+            if (!VFD_TX_INTERRUPTS_ENABLED()) {
+                service();
+            }
+        }
+    }
+
+    /**
+     * @brief Move the bus by 1 step; to be called from a timer compare interrupt.
+     */
+    static inline void service()
+    {
+        if (half_bits == 0) {
+            if (head == tail)
+                return;
+
+            uint16_t token = queue[tail];
+            tail = (tail + 1) & (VFD_TX_QUEUE_SIZE - 1);
+
+            if (token == VFD_TX_CS_LOW) {
+                Pins::csLow();
+                return;
+            }
+            if (token == VFD_TX_CS_HIGH) {
+                Pins::csHigh();
+                return;
+            }
+            shift_reg = token;
+            half_bits = 16;
+        }
+
+        if (half_bits & 1) {
+            // Data is read at the rising edge
+            Pins::clkHigh();
+            shift_reg >>= 1;
+        } else {
+            Pins::clkLow();
+            if (shift_reg & 1) {
+                Pins::dataHigh();
+            } else {
+                Pins::dataLow();
+            }
+        }
+        half_bits--;
+    }
+};
+
+template <class Pins> volatile uint16_t VFD_AsyncTransport<Pins>::queue[VFD_TX_QUEUE_SIZE];
+template <class Pins> volatile uint8_t  VFD_AsyncTransport<Pins>::head;
+template <class Pins> volatile uint8_t  VFD_AsyncTransport<Pins>::tail;
+template <class Pins> volatile uint8_t  VFD_AsyncTransport<Pins>::half_bits;
+template <class Pins> uint8_t           VFD_AsyncTransport<Pins>::shift_reg;
+template <class Pins> bool              VFD_AsyncTransport<Pins>::cs_high = true;
+#endif
+
+
+#if defined(VFD_TRANSPORT_HOST) && ENABLE_ASYNC_TX == 1
+// Host build: queued bit-bang on recorded pins
+typedef VFD_AsyncTransport<VFD_HostPins> VFD_Transport;
+
+#elif defined(VFD_TRANSPORT_HOST)
+// Host build: bit-bang on recorded pins
+typedef VFD_BitBangTransport<VFD_HostPins> VFD_Transport;
+
+#elif ENABLE_ASYNC_TX == 1
+#if defined(VFD_TRANSPORT_SPI) || defined(VFD_TRANSPORT_USI)
+    #error "ENABLE_ASYNC_TX is only available with VFD_TRANSPORT_BITBANG"
+#endif
+typedef VFD_AsyncTransport<VFD_AvrPins> VFD_Transport;
+
+#elif defined(VFD_TRANSPORT_SPI)
+// Clock rate: the PT6312 accepts up to ~1MHz
+#if VFD_SPI_CLOCK_DIV == 4
+    #define VFD_SPI_CLOCK_BITS 0
+#elif VFD_SPI_CLOCK_DIV == 16
+    #define VFD_SPI_CLOCK_BITS (1 << SPR0)
+#elif VFD_SPI_CLOCK_DIV == 64
+    #define VFD_SPI_CLOCK_BITS (1 << SPR1)
+#elif VFD_SPI_CLOCK_DIV == 128
+    #define VFD_SPI_CLOCK_BITS ((1 << SPR1) | (1 << SPR0))
+#else
+    #error "VFD_SPI_CLOCK_DIV must be 4, 16, 64 or 128"
+#endif
+
+/**
+ * Hardware SPI transport (ATmega): SCLK on SCK, DATA on MOSI with MISO tied to it.
+ * CS and the DATA line direction are handled like the bit-bang transport.
+ */
+struct VFD_SpiTransport : VFD_BitBangTransport<VFD_AvrPins>
+{
+    static inline void init()
+    {
+        VFD_AvrPins::init();
+        // SS must be an output, otherwise the SPI may fall back to slave mode
+        _pinMode(VFD_SPI_SS_DDR, VFD_SPI_SS_PIN, _OUTPUT);
+        // Enable SPI, master, LSB first, mode 3 (CPOL=1, CPHA=1)
+        SPCR = (1 << SPE) | (1 << MSTR) | (1 << DORD) | (1 << CPOL) | (1 << CPHA) | VFD_SPI_CLOCK_BITS;
+    }
+
+    static inline void write(uint8_t value)
+    {
+        SPDR = value;
+        loop_until_bit_is_set(SPSR, SPIF);
+    }
+
+    static inline uint8_t read()
+    {
+        // MOSI is an input here: only the clock is generated
+        SPDR = 0xFF;
+        loop_until_bit_is_set(SPSR, SPIF);
+        return SPDR;
+    }
+};
+typedef VFD_SpiTransport VFD_Transport;
+
+#elif defined(VFD_TRANSPORT_USI)
+/**
+ * USI three-wire transport (ATtiny): SCLK on USCK, DATA on DO with DI tied to it.
+ * CS and the DATA line direction are handled like the bit-bang transport.
+ */
+struct VFD_UsiTransport : VFD_BitBangTransport<VFD_AvrPins>
+{
+    static inline void init()
+    {
+        VFD_AvrPins::init();
+        USICR = (1 << USIWM0) | (1 << USICS1) | (1 << USICLK);
+    }
+
+    /**
+     * @brief Mirror the bits of a byte; the USI only shifts data MSB first.
+     */
+    static inline uint8_t reverseBits(uint8_t value)
+    {
+        value = (value >> 4) | (value << 4);
+        value = ((value & 0xCC) >> 2) | ((value & 0x33) << 2);
+        value = ((value & 0xAA) >> 1) | ((value & 0x55) << 1);
+        return value;
+    }
+
+    /**
+     * @brief Shift the USI data register through 8 clock cycles (16 edges).
+     *      SCLK starts HIGH: DO is updated on falling edges, DI is sampled on rising edges.
+     * @return Content of the data register after the transfer.
+     */
+    static inline uint8_t transfer(uint8_t value)
+    {
+        USIDR = value;
+        USISR = (1 << USIOIF); // Clear the counter overflow flag & the 4 bits counter
+        do {
+            // Three-wire mode, shift on positive edges, software clock strobe, toggle USCK
+            USICR = (1 << USIWM0) | (1 << USICS1) | (1 << USICLK) | (1 << USITC);
+            _delay_us(0.5);
+        } while ((USISR & (1 << USIOIF)) == 0);
+        return USIDR;
+    }
+
+    static inline void write(uint8_t value)
+    {
+        transfer(reverseBits(value));
+    }
+
+    static inline uint8_t read()
+    {
+        // DO is an input here: only the clock is generated
+        return reverseBits(transfer(0xFF));
+    }
+};
+typedef VFD_UsiTransport VFD_Transport;
+
+#else
+typedef VFD_BitBangTransport<VFD_AvrPins> VFD_Transport;
+#endif
+
+// Bus protocol over the transport of global.h (used by the C API)
+typedef PT6312Driver<VFD_Transport> VFD_Driver;
+
+#endif // PT6312_TRANSPORT_H